@@ -0,0 +1,98 @@
+/* Small double-double arithmetic library - arrays module
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "ddouble.h"
+
+namespace xprec {
+
+/**
+ * Array of double-double numbers in structure-of-arrays (SoA) layout.
+ *
+ * A std::vector<DDouble> interleaves the hi and lo parts in memory, which
+ * means that every element-wise loop over it needs strided loads.  This
+ * container instead stores all hi parts and all lo parts in two separate,
+ * contiguous planes.  The element-wise kernels below then only perform
+ * contiguous loads and stores, and the branch-free algorithms of Joldes et
+ * al. can be vectorized by the compiler.
+ *
+ * Elements are returned by value, since there is no DDouble object in
+ * memory to refer to.  Use set() to modify single elements.
+ */
+class DDoubleArray {
+public:
+    DDoubleArray() = default;
+
+    /** Construct array of n elements, all of which are zero. */
+    explicit DDoubleArray(size_t n) : _hi(n), _lo(n) { }
+
+    /** Construct array of n elements, all of which are x. */
+    DDoubleArray(size_t n, DDouble x) : _hi(n, x.hi()), _lo(n, x.lo()) { }
+
+    /** Construct array from n elements in interleaved layout. */
+    DDoubleArray(const DDouble *x, size_t n);
+
+    /** Number of elements */
+    size_t size() const { return _hi.size(); }
+
+    /** True if array has no elements */
+    bool empty() const { return _hi.empty(); }
+
+    /** Change number of elements, new elements are zero. */
+    void resize(size_t n)
+    {
+        _hi.resize(n);
+        _lo.resize(n);
+    }
+
+    /** Get i-th element */
+    DDouble operator[](size_t i) const { return DDouble(_hi[i], _lo[i]); }
+
+    /** Set i-th element to x */
+    void set(size_t i, DDouble x)
+    {
+        _hi[i] = x.hi();
+        _lo[i] = x.lo();
+    }
+
+    /** Copy all elements to x in interleaved layout */
+    void get(DDouble *x) const;
+
+    /** Pointer to contiguous plane of hi parts */
+    double *hi() { return _hi.data(); }
+    const double *hi() const { return _hi.data(); }
+
+    /** Pointer to contiguous plane of lo parts */
+    double *lo() { return _lo.data(); }
+    const double *lo() const { return _lo.data(); }
+
+private:
+    std::vector<double> _hi;
+    std::vector<double> _lo;
+};
+
+// Element-wise kernels.  The output array is resized to match the input and
+// may be the same object as one of the inputs.  Binary kernels expect both
+// inputs to be of the same size.
+
+/** Element-wise sum: z[i] = x[i] + y[i] */
+void add(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z);
+
+/** Element-wise difference: z[i] = x[i] - y[i] */
+void subtract(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z);
+
+/** Element-wise product: z[i] = x[i] * y[i] */
+void multiply(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z);
+
+/** Element-wise quotient: z[i] = x[i] / y[i] */
+void divide(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z);
+
+/** Element-wise reciprocal: z[i] = 1 / x[i] */
+void reciprocal(const DDoubleArray &x, DDoubleArray &z);
+
+} /* namespace xprec */
@@ -0,0 +1,139 @@
+/* Small double-double arithmetic library - reductions and linear algebra
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+
+#include "ddouble.h"
+
+namespace xprec {
+
+/**
+ * Sum of n doubles, computed as accurately as in double-double arithmetic.
+ *
+ * This is the Sum2 algorithm of Ogita, Rump and Oishi [^1]: the sum is
+ * accumulated in double precision, and the rounding error of each addition
+ * is recovered with two_sum and collected in a separate double.  Returning
+ * both parts gives a result whose error is bounded by about n u^2 sum(|x|).
+ * This is much cheaper than promoting the input to DDouble first.
+ *
+ * [^1]: T. Ogita, S. M. Rump and S. Oishi, SIAM J. Sci. Comput. 26, 1955
+ *       (2005)
+ */
+DDouble sum(const double *x, size_t n);
+
+/** Sum of n double-double numbers (see sum(const double *, size_t)) */
+DDouble sum(const DDouble *x, size_t n);
+
+/**
+ * Dot product of two vectors of n doubles in double-double precision.
+ *
+ * This is the Dot2 algorithm of Ogita, Rump and Oishi: each product is split
+ * into p + e with two_prod, the p are summed with Sum2 and the e are added to
+ * the correction.  The error is bounded by about n u^2 sum(|x * y|), so the
+ * result is accurate even for ill-conditioned dot products.
+ */
+DDouble dot(const double *x, const double *y, size_t n);
+
+/** Dot product of two vectors of n double-double numbers */
+DDouble dot(const DDouble *x, const DDouble *y, size_t n);
+
+/**
+ * Accumulator for sums which are reproducible bit by bit.
+ *
+ * Floating-point addition is not associative, so an ordinary sum depends on
+ * how the terms are distributed over threads or SIMD lanes.  This class
+ * instead pre-rounds each term against fixed boundaries derived from a bound
+ * max_abs on the terms [^2]: every term is cut into slices, which are
+ * multiples of fixed powers of two, and the slices of each level are summed
+ * without any rounding error.  The result is thus independent of the order
+ * and partitioning of the terms, as long as all partial accumulators were
+ * constructed with the same arguments.
+ *
+ * For a parallel reduction, first determine max_abs over all terms, then
+ * give each thread its own accumulator and merge them with operator+=.
+ *
+ * The absolute error is below 2^(5 * log2(max_n) - 204) max_abs, so up to
+ * about a million terms, it is below the double-double rounding error of
+ * max_abs.  Terms that are infinite or NaN propagate to the result.  Adding
+ * more than max_n terms is allowed and keeps the result reproducible, but
+ * the error bound then grows proportionally to the number of terms.
+ *
+ * [^2]: J. Demmel and H. D. Nguyen, Proc. 21st IEEE ARITH, 163 (2013)
+ */
+class ReproducibleSum {
+public:
+    /**
+     * Prepare to sum at most max_n terms, each at most max_abs in magnitude.
+     *
+     * max_n is the total number of terms over all accumulators that are
+     * eventually merged, where each DDouble counts as two terms.
+     */
+    ReproducibleSum(double max_abs, size_t max_n);
+
+    /** Add single term x, where abs(x) <= max_abs */
+    void add(double x);
+
+    /** Add n terms from x, all of which must satisfy abs(x[i]) <= max_abs */
+    void add(const double *x, size_t n);
+
+    /** Add n double-double terms, where abs(x[i].hi()) <= max_abs */
+    void add(const DDouble *x, size_t n);
+
+    /** Merge other accumulator, which must be constructed the same way */
+    ReproducibleSum &operator+=(const ReproducibleSum &other);
+
+    /** Sum of all terms added so far, rounded to double-double */
+    DDouble result() const;
+
+private:
+    static const int LEVELS = 4;
+
+    PowerOfTwo _scale;
+    double _sigma[LEVELS];
+    double _sum[LEVELS];
+    double _carry;
+    double _special;
+    size_t _count, _max_n;
+};
+
+/**
+ * Sum of n doubles which is reproducible bit by bit.
+ *
+ * The result does not depend on the order of the terms, the SIMD width or
+ * the number of threads.  This requires two passes over x: one to find the
+ * largest term and one for the sum (see ReproducibleSum).
+ */
+DDouble reproducible_sum(const double *x, size_t n);
+
+/** Sum of n double-double numbers which is reproducible bit by bit */
+DDouble reproducible_sum(const DDouble *x, size_t n);
+
+/**
+ * General matrix-matrix product: C = alpha * A * B + beta * C.
+ *
+ * A is m x k, B is k x n and C is m x n.  As in BLAS, all matrices are
+ * stored in column-major order with leading dimensions lda, ldb and ldc,
+ * and C need not be initialized if beta is zero.
+ *
+ * C is computed in tiles, which are distributed over threads: use the
+ * environment variable XPREC_NUM_THREADS to limit the number of threads.
+ * Within each tile, panels of A and B are packed into contiguous buffers
+ * and multiplied with a register-blocked kernel on DDoubleVec packs.
+ */
+void gemm(size_t m, size_t n, size_t k, DDouble alpha, const DDouble *a,
+          size_t lda, const DDouble *b, size_t ldb, DDouble beta, DDouble *c,
+          size_t ldc);
+
+/**
+ * General matrix-vector product: y = alpha * A * x + beta * y.
+ *
+ * A is m x n in column-major order with leading dimension lda, x has n and
+ * y has m elements.  y need not be initialized if beta is zero.
+ */
+void gemv(size_t m, size_t n, DDouble alpha, const DDouble *a, size_t lda,
+          const DDouble *x, DDouble beta, DDouble *y);
+
+} /* namespace xprec */
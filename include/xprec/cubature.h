@@ -0,0 +1,93 @@
+/* Small double-double arithmetic library - multidimensional quadrature
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "array.h"
+#include "ddouble.h"
+#include "quadrature.h"
+
+namespace xprec {
+
+/**
+ * Quadrature rule on the hypercube [-1, 1]^dim.
+ *
+ * Coordinate k of the nodes and the weights are stored in structure-of-arrays
+ * layout (see DDoubleArray), where node i is (x(0)[i], ..., x(dim-1)[i]).
+ */
+class CubatureRule {
+public:
+    /** Construct rule from coordinates x[k] of the nodes and weights w */
+    CubatureRule(std::vector<DDoubleArray> x, DDoubleArray w);
+
+    /** Number of dimensions */
+    int dim() const { return (int)_x.size(); }
+
+    /** Number of nodes */
+    size_t size() const { return _w.size(); }
+
+    /** Coordinate k of the nodes */
+    const DDoubleArray &x(int k) const { return _x[k]; }
+
+    /** Weights */
+    const DDoubleArray &w() const { return _w; }
+
+private:
+    std::vector<DDoubleArray> _x;
+    DDoubleArray _w;
+};
+
+/**
+ * Tensor-product rule of the one-dimensional rule of given family and order n
+ * in each of dim >= 1 dimensions, with n^dim nodes.
+ *
+ * The nodes are ordered in tiles of up to 64 neighbouring nodes, e.g., 8 x 8
+ * in 2D and 4 x 4 x 4 in 3D, rather than row by row, so that consecutive
+ * nodes are close to each other in every dimension.
+ */
+CubatureRule tensor_rule(QuadratureCache::Family family, int dim, int n);
+
+/**
+ * Smolyak sparse grid of given level >= 0 in dim >= 1 dimensions.
+ *
+ * Combines the tensor products of one-dimensional rules of the given family
+ * with levels l[k] >= 0 over all level sums level - dim < |l| <= level.
+ * Coinciding nodes are merged, and the nodes are sorted lexicographically.
+ * Some weights may be negative.  The grid is exact for polynomials of total
+ * degree up to 2 level + 1 (with respect to the weight function of the
+ * family).
+ *
+ * Level l has l + 1 nodes.  In four or more dimensions, the sparse grid has
+ * far fewer nodes than the tensor-product rule of the same degree, e.g.,
+ * 1433 instead of 15625 for degree 9 in six dimensions.
+ */
+CubatureRule smolyak_rule(QuadratureCache::Family family, int dim, int level);
+
+/**
+ * Multidimensional integrand, which stores f(x[0][i], ..., x[dim-1][i]) in
+ * fx[i] for i = 0, ..., n-1.
+ *
+ * The integrand is called with batches of nodes and may be called
+ * concurrently from several threads.
+ */
+typedef std::function<void(const DDouble *const *x, DDouble *fx, size_t n)>
+    CubatureIntegrand;
+
+/**
+ * Integrate f over the box [a[0], b[0]] x ... x [a[dim-1], b[dim-1]] using
+ * the given rule.
+ *
+ * The nodes are mapped onto the box and evaluated in batches on up to
+ * nthreads threads, where zero means max_threads().  The partial sums of the
+ * batches are added up in order, so the result does not depend on the number
+ * of threads.
+ */
+DDouble cubature(const CubatureIntegrand &f, const CubatureRule &rule,
+                 const DDouble *a, const DDouble *b, unsigned nthreads = 0);
+
+} /* namespace xprec */
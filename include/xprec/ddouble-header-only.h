@@ -5,6 +5,8 @@
  * considerably longer compile times.
  *
  * Please also note that this header WILL NOT be installed by `make install`.
+ * The matrix products use std::thread, so you may need to compile with
+ * -pthread or link against Threads::Threads.
  *
  * Copyright (C) 2023 Markus Wallerberger and others
  * SPDX-License-Identifier: MIT
@@ -16,10 +18,19 @@
 // directly.
 #define XPREC_API_EXPORT inline
 
+#include "../../src/array.cxx"
+#include "../../src/blas.cxx"
 #include "../../src/circular.cxx"
+#include "../../src/clenshaw.cxx"
+#include "../../src/cubature.cxx"
 #include "../../src/exp.cxx"
 #include "../../src/gauss.cxx"
 #include "../../src/hyperbolic.cxx"
+#include "../../src/integrate.cxx"
 #include "../../src/io.cxx"
+#include "../../src/linalg.cxx"
+#include "../../src/quadrature.cxx"
+#include "../../src/rulefile.cxx"
 #include "../../src/sqrt.cxx"
+#include "../../src/tanhsinh.cxx"
 #include "ddouble.h"
@@ -12,6 +12,19 @@
 
 #include "version.h"
 
+// Error-free products are computed with a fused multiply-add (FMA) if the
+// hardware supports it.  Otherwise, std::fma is a slow library call, and we
+// use Dekker's algorithm with Veltkamp splitting instead.  Define XPREC_FMA
+// to 1 or 0 to override the automatic choice.
+#ifndef XPREC_FMA
+#if defined(__FMA__) || defined(__FP_FAST_FMA) ||                             \
+    defined(__ARM_FEATURE_FMA) || (defined(_MSC_VER) && defined(__AVX2__))
+#define XPREC_FMA 1
+#else
+#define XPREC_FMA 0
+#endif
+#endif
+
 namespace xprec {
 
 /**
@@ -286,6 +299,7 @@ DDouble pow(DDouble a, int b);
 DDouble round(DDouble a);
 DDouble scalbn(DDouble a, int m);
 DDouble sin(DDouble a);
+void sincos(DDouble a, DDouble &s, DDouble &c);
 DDouble sinh(DDouble a);
 DDouble sqrt(DDouble a);
 DDouble tan(DDouble a);
@@ -300,6 +314,25 @@ bool isnormal(DDouble x);
 bool iszero(DDouble x);
 std::string to_string(DDouble d, size_t nDigits = 34);
 
+// Batched versions of the mathematical functions: compute y[i] = f(x[i]) for
+// i = 0, ..., n-1.  They give the same results as the scalar functions up to
+// round-off, but process several arguments at once using SIMD instructions.
+// The output array may be the same as the input array.
+
+void exp(const DDouble *x, DDouble *y, size_t n);
+void expm1(const DDouble *x, DDouble *y, size_t n);
+void log(const DDouble *x, DDouble *y, size_t n);
+void log1p(const DDouble *x, DDouble *y, size_t n);
+void sin(const DDouble *x, DDouble *y, size_t n);
+void cos(const DDouble *x, DDouble *y, size_t n);
+void tan(const DDouble *x, DDouble *y, size_t n);
+
+/** Batched sincos: s[i] = sin(x[i]), c[i] = cos(x[i]). */
+void sincos(const DDouble *x, DDouble *s, DDouble *c, size_t n);
+
+/** Batched power: z[i] = pow(x[i], y[i]); z may be the same as x or y. */
+void pow(const DDouble *x, const DDouble *y, DDouble *z, size_t n);
+
 /**
  * Gauss-Chebyshev quadrature rule.
  *
@@ -316,9 +349,109 @@ void gauss_chebyshev(int n, DDouble x[], DDouble w[] = nullptr);
  * Expects x and (optionally) w to be arrays of at least size n. Fill x with
  * the Gauss-Legendre quadrature nodes of order n, i.e., the roots of the n-th
  * Legendre polynomial. If w is given, store the quadrature weights there.
+ *
+ * For n >= 100, the rule is computed from asymptotic expansions in O(n) time,
+ * so orders up to millions are feasible.  This path splits the nodes into
+ * tasks of 256, which run on several threads (see XPREC_NUM_THREADS) once
+ * there is more than one, i.e., from n of about 540 on.
  */
 void gauss_legendre(int n, DDouble x[], DDouble w[] = nullptr);
 
+/**
+ * Gauss-Jacobi quadrature rule.
+ *
+ * Expects x and (optionally) w to be arrays of at least size n. Fill x with
+ * the nodes of the Gauss rule of order n for the weight function
+ * (1 - x)^alpha (1 + x)^beta on [-1, 1], where alpha, beta > -1, i.e., the
+ * roots of the n-th Jacobi polynomial, in ascending order. If w is given,
+ * store the quadrature weights there.
+ *
+ * The nodes are found from the Jacobi matrix in double precision and then
+ * refined by Newton iteration in double-double precision, which takes O(n^2)
+ * time.
+ */
+void gauss_jacobi(int n, double alpha, double beta, DDouble x[],
+                  DDouble w[] = nullptr);
+
+/**
+ * Gauss-Radau quadrature rule for the Jacobi weight.
+ *
+ * Same as gauss_jacobi(), except that x[0] = -1 is prescribed as a node, so
+ * the rule is exact for polynomials up to degree 2n-2.  For a rule with a node
+ * at +1 instead, swap alpha and beta and flip the sign of the nodes.
+ */
+void gauss_jacobi_radau(int n, double alpha, double beta, DDouble x[],
+                        DDouble w[] = nullptr);
+
+/**
+ * Gauss-Lobatto quadrature rule for the Jacobi weight.
+ *
+ * Same as gauss_jacobi(), except that both x[0] = -1 and x[n-1] = 1 are
+ * prescribed as nodes, so the rule is exact for polynomials up to degree
+ * 2n-3.  Requires n >= 2: for n = 1, there is no such rule and x[0] and w[0]
+ * are set to NaN.  For alpha = beta = 0, this is the Legendre-Gauss-Lobatto
+ * rule used in spectral element methods.
+ */
+void gauss_jacobi_lobatto(int n, double alpha, double beta, DDouble x[],
+                          DDouble w[] = nullptr);
+
+/**
+ * Gauss-Laguerre quadrature rule.
+ *
+ * Expects x and (optionally) w to be arrays of at least size n. Fill x with
+ * the nodes of the Gauss rule of order n for the weight function
+ * x^alpha exp(-x) on [0, inf), where alpha > -1, in ascending order. If w is
+ * given, store the quadrature weights there.  Weights which are smaller than
+ * the smallest double are flushed to zero.
+ */
+void gauss_laguerre(int n, double alpha, DDouble x[], DDouble w[] = nullptr);
+
+/**
+ * Gauss-Hermite quadrature rule.
+ *
+ * Expects x and (optionally) w to be arrays of at least size n. Fill x with
+ * the nodes of the Gauss rule of order n for the weight function exp(-x^2) on
+ * the real line, i.e., the roots of the n-th (physicists') Hermite
+ * polynomial, in ascending order. If w is given, store the quadrature weights
+ * there.  Weights which are smaller than the smallest double are flushed to
+ * zero.
+ */
+void gauss_hermite(int n, DDouble x[], DDouble w[] = nullptr);
+
+/**
+ * Clenshaw-Curtis quadrature rule.
+ *
+ * Expects x and (optionally) w to be arrays of at least size n. Fill x with
+ * the n Chebyshev extreme points -cos(i pi/(n-1)), including the end points
+ * -1 and 1, in ascending order. If w is given, store the quadrature weights
+ * there, which are computed by FFT in O(n log n) time.  The rule is exact for
+ * polynomials up to degree n-1.
+ *
+ * The rules are nested: the nodes of order n are the even-indexed nodes of
+ * order 2n-1, so doubling the number of intervals reuses all function values.
+ */
+void clenshaw_curtis(int n, DDouble x[], DDouble w[] = nullptr);
+
+/**
+ * Fejer's first quadrature rule.
+ *
+ * Expects x and (optionally) w to be arrays of at least size n. Fill x with
+ * the nodes of gauss_chebyshev(), the roots of the n-th Chebyshev polynomial.
+ * If w is given, store the quadrature weights for integrating over [-1, 1]
+ * without weight function there, which are computed by FFT in O(n log n)
+ * time.  The nodes of order n are contained in the rule of order 3n.
+ */
+void fejer1(int n, DDouble x[], DDouble w[] = nullptr);
+
+/**
+ * Fejer's second quadrature rule.
+ *
+ * Same as clenshaw_curtis(), but only uses the interior nodes
+ * -cos((i+1) pi/(n+1)), which is useful for integrands singular at the end
+ * points.  The nodes of order n are the odd-indexed nodes of order 2n+1.
+ */
+void fejer2(int n, DDouble x[], DDouble w[] = nullptr);
+
 /** Trigonometric complement sqrt(1 - x*x) to full precision. */
 DDouble trig_complement(DDouble x);
 
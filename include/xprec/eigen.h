@@ -5,6 +5,7 @@
  */
 #pragma once
 #include "ddouble.h"
+#include "simd.h"
 #include <Eigen/Core>
 
 namespace Eigen {
@@ -28,4 +29,254 @@ struct NumTraits<xprec::DDouble> : GenericNumTraits<xprec::DDouble>
     };
 };
 
+namespace internal {
+
+// Eigen vectorizes expressions of scalars for which packet_traits provides a
+// packet type and the basic packet operations below.  We use DDoubleVec
+// with the natural width for the instruction set, which gives vectorized
+// coefficient-wise operations, reductions and matrix products (GEBP).
+//
+// The double-double arithmetic is the same as for scalars, however, the
+// order of additions in reductions and products changes, and thus results
+// may differ from the scalar path by rounding.  Define XPREC_EIGEN_NO_SIMD
+// to disable vectorization.
+#ifndef XPREC_EIGEN_NO_SIMD
+
+typedef xprec::DDoubleVec<XPREC_SIMD_WIDTH> PacketDDouble;
+
+template <>
+struct packet_traits<xprec::DDouble> : default_packet_traits
+{
+    typedef PacketDDouble type;
+    typedef PacketDDouble half;
+
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = XPREC_SIMD_WIDTH,
+        HasHalfPacket = 0,
+
+        HasAdd = 1,
+        HasSub = 1,
+        HasShift = 0,
+        HasMul = 1,
+        HasNegate = 1,
+        HasAbs = 0,
+        HasAbs2 = 1,
+        HasMin = 0,
+        HasMax = 0,
+        HasConj = 1,
+        HasSetLinear = 0,
+        HasDiv = 1
+    };
+};
+
+template <>
+struct unpacket_traits<PacketDDouble>
+{
+    typedef xprec::DDouble type;
+    typedef PacketDDouble half;
+
+    enum {
+        size = XPREC_SIMD_WIDTH,
+        alignment = Aligned16,
+        vectorizable = true,
+        masked_load_available = false,
+        masked_store_available = false
+    };
+};
+
+// DDoubleVec only performs unaligned loads and stores, which are as fast
+// as aligned ones on current hardware.
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pset1<PacketDDouble>(const xprec::DDouble &a)
+{
+    return PacketDDouble(a);
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+pload<PacketDDouble>(const xprec::DDouble *from)
+{
+    return PacketDDouble::load(from);
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+ploadu<PacketDDouble>(const xprec::DDouble *from)
+{
+    return PacketDDouble::load(from);
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+ploaddup<PacketDDouble>(const xprec::DDouble *from)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    for (int i = 0; i != XPREC_SIMD_WIDTH; ++i)
+        tmp[i] = from[i / 2];
+    return PacketDDouble::load(tmp);
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+ploadquad<PacketDDouble>(const xprec::DDouble *from)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    for (int i = 0; i != XPREC_SIMD_WIDTH; ++i)
+        tmp[i] = from[i / 4];
+    return PacketDDouble::load(tmp);
+}
+
+template <>
+EIGEN_STRONG_INLINE void pstore<xprec::DDouble>(xprec::DDouble *to,
+                                                const PacketDDouble &from)
+{
+    from.store(to);
+}
+
+template <>
+EIGEN_STRONG_INLINE void pstoreu<xprec::DDouble>(xprec::DDouble *to,
+                                                 const PacketDDouble &from)
+{
+    from.store(to);
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+pgather<xprec::DDouble, PacketDDouble>(const xprec::DDouble *from,
+                                       Index stride)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    for (int i = 0; i != XPREC_SIMD_WIDTH; ++i)
+        tmp[i] = from[i * stride];
+    return PacketDDouble::load(tmp);
+}
+
+template <>
+EIGEN_STRONG_INLINE void
+pscatter<xprec::DDouble, PacketDDouble>(xprec::DDouble *to,
+                                        const PacketDDouble &from,
+                                        Index stride)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    from.store(tmp);
+    for (int i = 0; i != XPREC_SIMD_WIDTH; ++i)
+        to[i * stride] = tmp[i];
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble padd<PacketDDouble>(const PacketDDouble &a,
+                                                      const PacketDDouble &b)
+{
+    return a + b;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble psub<PacketDDouble>(const PacketDDouble &a,
+                                                      const PacketDDouble &b)
+{
+    return a - b;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pnegate<PacketDDouble>(const PacketDDouble &a)
+{
+    return -a;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pconj<PacketDDouble>(const PacketDDouble &a)
+{
+    return a;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pmul<PacketDDouble>(const PacketDDouble &a,
+                                                      const PacketDDouble &b)
+{
+    return a * b;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pdiv<PacketDDouble>(const PacketDDouble &a,
+                                                      const PacketDDouble &b)
+{
+    return a / b;
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble pmadd<PacketDDouble>(const PacketDDouble &a,
+                                                       const PacketDDouble &b,
+                                                       const PacketDDouble &c)
+{
+    return a * b + c;
+}
+
+template <>
+EIGEN_STRONG_INLINE xprec::DDouble pfirst<PacketDDouble>(const PacketDDouble &a)
+{
+    return a[0];
+}
+
+template <>
+EIGEN_STRONG_INLINE PacketDDouble
+preverse<PacketDDouble>(const PacketDDouble &a)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH], rev[XPREC_SIMD_WIDTH];
+    a.store(tmp);
+    for (int i = 0; i != XPREC_SIMD_WIDTH; ++i)
+        rev[i] = tmp[XPREC_SIMD_WIDTH - 1 - i];
+    return PacketDDouble::load(rev);
+}
+
+template <>
+EIGEN_STRONG_INLINE xprec::DDouble predux<PacketDDouble>(const PacketDDouble &a)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    a.store(tmp);
+    xprec::DDouble r = tmp[0];
+    for (int i = 1; i != XPREC_SIMD_WIDTH; ++i)
+        r += tmp[i];
+    return r;
+}
+
+template <>
+EIGEN_STRONG_INLINE xprec::DDouble
+predux_mul<PacketDDouble>(const PacketDDouble &a)
+{
+    xprec::DDouble tmp[XPREC_SIMD_WIDTH];
+    a.store(tmp);
+    xprec::DDouble r = tmp[0];
+    for (int i = 1; i != XPREC_SIMD_WIDTH; ++i)
+        r *= tmp[i];
+    return r;
+}
+
+/**
+ * Transpose block of M packets.
+ *
+ * Lane k of packet j is moved to position M * k + j of the concatenated
+ * packets.  For M equal to the packet size, this is the usual transpose;
+ * the matrix product also uses M = 4 for wider packets.
+ */
+template <int M>
+EIGEN_STRONG_INLINE void ptranspose(PacketBlock<PacketDDouble, M> &kernel)
+{
+    const int N = XPREC_SIMD_WIDTH;
+    xprec::DDouble in[M * N], out[M * N];
+    for (int j = 0; j != M; ++j)
+        kernel.packet[j].store(in + j * N);
+    for (int j = 0; j != M; ++j) {
+        for (int k = 0; k != N; ++k)
+            out[M * k + j] = in[j * N + k];
+    }
+    for (int j = 0; j != M; ++j)
+        kernel.packet[j] = PacketDDouble::load(out + j * N);
+}
+
+#endif /* XPREC_EIGEN_NO_SIMD */
+
+} /* namespace internal */
 } /* namespace Eigen */
@@ -0,0 +1,170 @@
+/* Small double-double arithmetic library - numerical integration
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "ddouble.h"
+
+namespace xprec {
+
+/**
+ * Gauss-Kronrod rule on [-1, 1].
+ *
+ * The (2n+1)-point Kronrod rule extends the n-point Gauss-Legendre rule: the
+ * Gauss nodes are x[1], x[3], ..., x[2n-1], and the n + 1 new nodes interlace
+ * with them.  The Kronrod rule is exact for polynomials up to degree 3n + 1,
+ * and the difference to the embedded Gauss rule serves as an error estimate.
+ */
+class GaussKronrodRule {
+public:
+    /** Construct the rule extending the n-point Gauss rule, n >= 1 */
+    explicit GaussKronrodRule(int n);
+
+    /** Number of Gauss nodes n */
+    int order() const { return _n; }
+
+    /** Number of Kronrod nodes 2n + 1 */
+    size_t size() const { return _x.size(); }
+
+    /** Kronrod nodes in ascending order */
+    const DDouble *x() const { return _x.data(); }
+
+    /** Kronrod weights */
+    const DDouble *w() const { return _w.data(); }
+
+    /** Gauss weights for the nodes x[1], x[3], ..., x[2n-1] */
+    const DDouble *gauss_w() const { return _gauss_w.data(); }
+
+private:
+    int _n;
+    std::vector<DDouble> _x, _w, _gauss_w;
+};
+
+/**
+ * Integrand, which stores f(x[i]) in fx[i] for i = 0, ..., n-1.
+ *
+ * The adaptive integrator passes the nodes of many subintervals at once, so
+ * the integrand can amortize overhead or vectorize over them.  It may be
+ * called concurrently from several threads.
+ */
+typedef std::function<void(const DDouble *x, DDouble *fx, size_t n)>
+    BatchIntegrand;
+
+/** Options for the adaptive integrator, see integrate() */
+struct IntegrateOptions {
+    /** Use the Kronrod extension of the order-point Gauss rule */
+    int order;
+
+    /** Absolute tolerance, in addition to the relative one */
+    DDouble abs_tol;
+
+    /** Maximum number of subintervals */
+    size_t max_intervals;
+
+    /** Number of threads, where zero means max_threads() */
+    unsigned threads;
+
+    IntegrateOptions()
+        : order(10)
+        , abs_tol(0.0)
+        , max_intervals(100000)
+        , threads(0)
+    { }
+};
+
+/** Result of integrate() and tanh_sinh() */
+struct IntegrateResult {
+    /** Estimate of the integral */
+    DDouble value;
+
+    /** Estimate of the absolute error */
+    DDouble error;
+
+    /** Number of subintervals used, which is one for tanh_sinh() */
+    size_t intervals;
+
+    /** Number of integrand evaluations */
+    size_t evaluations;
+
+    /** True if the requested tolerance was reached */
+    bool ok;
+};
+
+/**
+ * Integrate f over [a, b] by adaptive Gauss-Kronrod quadrature.
+ *
+ * Keeps a priority queue of subintervals ordered by their error estimate, the
+ * difference between the Kronrod and Gauss results.  In each round, the
+ * intervals with the largest errors are bisected, just enough of them to
+ * reach the tolerance if their errors vanished, and the new intervals are
+ * evaluated on several threads.  This stops once the total error estimate is
+ * at most max(tol * |value|, options.abs_tol, 16 eps * I), where I is the
+ * estimate of the integral of |f| and eps = 2^-105.  The last term is the
+ * round-off floor, which lets integrals that are zero or nearly so converge
+ * without an absolute tolerance.
+ *
+ * The sequence of subdivisions does not depend on the number of threads, so
+ * the result is reproducible.  If the tolerance cannot be reached, because
+ * the maximum number of intervals is exhausted or an interval cannot be
+ * bisected further, ok is false in the result.
+ */
+IntegrateResult integrate(const BatchIntegrand &f, DDouble a, DDouble b,
+                          DDouble tol,
+                          const IntegrateOptions &options = IntegrateOptions());
+
+/**
+ * Integrate f over [a, b] by adaptive Gauss-Kronrod quadrature.
+ *
+ * Same as above, but for an integrand evaluated at one point at a time.
+ */
+IntegrateResult integrate(const std::function<DDouble(DDouble)> &f, DDouble a,
+                          DDouble b, DDouble tol,
+                          const IntegrateOptions &options = IntegrateOptions());
+
+/**
+ * Integrand for tanh_sinh(), which gets both the node x and its signed
+ * distance xc to the closer end point of the interval, i.e., x - a or x - b.
+ *
+ * Close to an end point, x is rounded, while xc is accurate to double-double
+ * precision.  Integrands with a singularity at the end point, e.g.,
+ * 1/sqrt(1 - x) on [0, 1], should thus be expressed in terms of xc.  For
+ * infinite intervals, xc is the distance from the finite end point, or x for
+ * the whole real line.
+ */
+typedef std::function<DDouble(DDouble x, DDouble xc)> EndpointIntegrand;
+
+/**
+ * Integrate f over [a, b] by tanh-sinh (double exponential) quadrature.
+ *
+ * Maps [a, b] onto the real line, such that the integrand decays double
+ * exponentially, and applies the trapezoidal rule with step 2^-k on level k.
+ * Each level only evaluates the new nodes, halfway between the previous
+ * ones, and stops once the estimate changes by at most max(tol * |value|,
+ * abs_tol) between two levels, or after max_level <= 12 levels.  As for
+ * integrate(), changes below 16 eps times the integral of |f| are considered
+ * round-off, so vanishing integrals also converge for abs_tol = 0.  The nodes
+ * and weights are computed once for each level and shared between calls.
+ *
+ * This converges rapidly also for integrands with singularities at the end
+ * points, as long as they are integrable.  a may be -inf and b may be +inf,
+ * in which case exp-sinh or sinh-sinh quadrature is used.
+ */
+IntegrateResult tanh_sinh(const EndpointIntegrand &f, DDouble a, DDouble b,
+                          DDouble tol, int max_level = 10,
+                          DDouble abs_tol = 0.0);
+
+/**
+ * Integrate f over [a, b] by tanh-sinh (double exponential) quadrature.
+ *
+ * Same as above, but for an integrand which only gets the node x.
+ */
+IntegrateResult tanh_sinh(const std::function<DDouble(DDouble)> &f, DDouble a,
+                          DDouble b, DDouble tol, int max_level = 10,
+                          DDouble abs_tol = 0.0);
+
+} /* namespace xprec */
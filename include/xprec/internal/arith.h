@@ -19,6 +19,109 @@ inline PowerOfTwo operator*(PowerOfTwo a, PowerOfTwo b) { return a._x * b._x; }
 
 inline PowerOfTwo operator/(PowerOfTwo a, PowerOfTwo b) { return a._x / b._x; }
 
+// -------------------------------------------------------------------------
+// Error-free products
+
+namespace _internal {
+
+/**
+ * Veltkamp splitting of a into hi + lo, where both parts have at most 26
+ * significant bits, so their pairwise products are exact.
+ */
+inline void veltkamp_split(double a, double &hi, double &lo)
+{
+    const double factor = 134217729.0; // 2^27 + 1
+    const double big = 6.696928794914171e+299; // 2^996
+    if (std::fabs(a) > big) {
+        // Avoid overflow in factor * a by scaling with powers of two.  One
+        // step suffices for finite a, and infinite a yields NaN as for FMA.
+        double as = a * 3.7252902984619140625e-09; // 2^-28
+        double c = factor * as;
+        double h = c - (c - as);
+        hi = h * 268435456.0;
+        lo = (as - h) * 268435456.0;
+        return;
+    }
+    double c = factor * a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+/** Error-free product a * b = p + e using FMA: cost 2 flops */
+inline double two_prod_fma(double a, double b, double &e)
+{
+    double p = a * b;
+    e = std::fma(a, b, -p);
+    return p;
+}
+
+/**
+ * Error-free product a * b = p + e using Dekker's algorithm: cost 17 flops.
+ *
+ * This is correct as long as the compiler does not contract the splitting
+ * into FMAs, which is only a concern if the hardware has FMA in the first
+ * place, and then two_prod_fma is preferable anyway.
+ */
+inline double two_prod_dekker(double a, double b, double &e)
+{
+    double p = a * b;
+    double a_hi, a_lo, b_hi, b_lo;
+    veltkamp_split(a, a_hi, a_lo);
+    veltkamp_split(b, b_hi, b_lo);
+    e = (((a_hi * b_hi - p) + a_hi * b_lo) + a_lo * b_hi) + a_lo * b_lo;
+    return p;
+}
+
+/** Error-free product a * b = p + e (see XPREC_FMA) */
+inline double two_prod(double a, double b, double &e)
+{
+#if XPREC_FMA
+    return two_prod_fma(a, b, e);
+#else
+    return two_prod_dekker(a, b, e);
+#endif
+}
+
+/**
+ * Compute a * b + c with a single rounding (see XPREC_FMA).
+ *
+ * Without FMA, we add p + c exactly (Algorithm 2) and then fold in the
+ * remainders, which agrees with std::fma except in rare double rounding cases.
+ */
+inline double mul_add(double a, double b, double c)
+{
+#if XPREC_FMA
+    return std::fma(a, b, c);
+#else
+    double e;
+    double p = two_prod_dekker(a, b, e);
+    double s = p + c;
+    double p_prime = s - c;
+    double c_prime = s - p_prime;
+    double t = (p - p_prime) + (c - c_prime);
+    return s + (t + e);
+#endif
+}
+
+/**
+ * Compute a * b + c with a single rounding, where c + a * b cancels.
+ *
+ * WARNING: c must be within a factor of two of -a * b.
+ */
+inline double mul_add_cancel(double a, double b, double c)
+{
+#if XPREC_FMA
+    return std::fma(a, b, c);
+#else
+    // c + p is exact by Sterbenz' lemma, so the only rounding is the last
+    double e;
+    double p = two_prod_dekker(a, b, e);
+    return (c + p) + e;
+#endif
+}
+
+} /* namespace _internal */
+
 // -------------------------------------------------------------------------
 // ExDouble
 
@@ -79,8 +182,8 @@ inline DDouble operator-(double a, ExDouble b) { return a + (-b); }
 inline DDouble operator*(ExDouble a, ExDouble b)
 {
     // Algorithm 3: cost 2 flops
-    double pi = (double)a * (double)b;
-    double rho = std::fma((double)a, (double)b, -pi);
+    double rho;
+    double pi = _internal::two_prod(a, b, rho);
     return DDouble(pi, rho);
 }
 
@@ -91,7 +194,7 @@ inline DDouble reciprocal(ExDouble y)
 {
     // Part of Algorithm 18 for y_lo = 0
     double th = 1.0 / (double)y;
-    double rh = std::fma(-(double)y, th, 1.0);
+    double rh = _internal::mul_add_cancel(-(double)y, th, 1.0);
     DDouble delta = ExDouble(rh) * th;
     return delta + th;
 }
@@ -99,7 +202,7 @@ inline DDouble reciprocal(ExDouble y)
 inline DDouble operator/(ExDouble a, ExDouble b)
 {
     // Algorithm 18 for this special case
-    return reciprocal(a) * (double)b;
+    return reciprocal(b) * (double)a;
 }
 
 inline DDouble operator/(double a, ExDouble b) { return ExDouble(a) / b; }
@@ -150,7 +253,7 @@ inline DDouble operator*(DDouble x, double y)
 {
     // Algorithm 9: cost 6 flops, error 2 u^2
     DDouble c = ExDouble(x._hi) * y;
-    double cl3 = std::fma(x._lo, y, c._lo);
+    double cl3 = _internal::mul_add(x._lo, y, c._lo);
     return ExDouble(c.hi()).add_small(cl3);
 }
 
@@ -159,8 +262,8 @@ inline DDouble operator*(DDouble x, DDouble y)
     // Algorithm 12: cost 9 flops, error 4 u^2 (corrected)
     DDouble c = ExDouble(x._hi) * y._hi;
     double tl0 = x._lo * y._lo;
-    double tl1 = std::fma(x._hi, y._lo, tl0);
-    double cl2 = std::fma(x._lo, y._hi, tl1);
+    double tl1 = _internal::mul_add(x._hi, y._lo, tl0);
+    double cl2 = _internal::mul_add(x._lo, y._hi, tl1);
     double cl3 = c._lo + cl2;
     return ExDouble(c._hi).add_small(cl3);
 }
@@ -181,7 +284,7 @@ inline DDouble reciprocal(DDouble y)
 {
     // Part of Algorithm 18: cost 22 flops, error 2.3 u^2
     double th = 1.0 / y._hi;
-    double rh = std::fma(-y._hi, th, 1.0);
+    double rh = _internal::mul_add_cancel(-y._hi, th, 1.0);
     double rl = -y._lo * th;
     DDouble e = ExDouble(rh).add_small(rl);
     DDouble delta = e * th;
@@ -0,0 +1,390 @@
+/* Implementations.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY: Include simd.h instead.
+ *
+ * Specializations of DoubleVec for the x86 vector extensions.  Each one
+ * must provide the same interface as the generic DoubleVec.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include "../simd.h"
+
+namespace xprec {
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+template <>
+class DoubleVec<2> {
+public:
+    static constexpr int width = 2;
+
+    DoubleVec() = default;
+    DoubleVec(double x) : _x(_mm_set1_pd(x)) { }
+    DoubleVec(__m128d x) : _x(x) { }
+
+    operator __m128d() const { return _x; }
+
+    static DoubleVec load(const double *p) { return _mm_loadu_pd(p); }
+
+    static void load_pairs(const double *p, DoubleVec &even, DoubleVec &odd)
+    {
+        __m128d a = _mm_loadu_pd(p);
+        __m128d b = _mm_loadu_pd(p + 2);
+        even = _mm_unpacklo_pd(a, b);
+        odd = _mm_unpackhi_pd(a, b);
+    }
+
+    void store(double *p) const { _mm_storeu_pd(p, _x); }
+
+    static void store_pairs(double *p, DoubleVec even, DoubleVec odd)
+    {
+        _mm_storeu_pd(p, _mm_unpacklo_pd(even._x, odd._x));
+        _mm_storeu_pd(p + 2, _mm_unpackhi_pd(even._x, odd._x));
+    }
+
+    static DoubleVec gather(const double *base, DoubleVec index)
+    {
+        double tmp[2];
+        index.store(tmp);
+        for (int i = 0; i != 2; ++i)
+            tmp[i] = base[(int)tmp[i]];
+        return load(tmp);
+    }
+
+    double operator[](int i) const
+    {
+        double tmp[2];
+        store(tmp);
+        return tmp[i];
+    }
+
+    friend DoubleVec operator+(DoubleVec a) { return a; }
+    friend DoubleVec operator-(DoubleVec a)
+    {
+        return _mm_xor_pd(a._x, _mm_set1_pd(-0.0));
+    }
+
+    friend DoubleVec operator+(DoubleVec a, DoubleVec b)
+    {
+        return _mm_add_pd(a._x, b._x);
+    }
+    friend DoubleVec operator-(DoubleVec a, DoubleVec b)
+    {
+        return _mm_sub_pd(a._x, b._x);
+    }
+    friend DoubleVec operator*(DoubleVec a, DoubleVec b)
+    {
+        return _mm_mul_pd(a._x, b._x);
+    }
+    friend DoubleVec operator/(DoubleVec a, DoubleVec b)
+    {
+        return _mm_div_pd(a._x, b._x);
+    }
+
+    friend DoubleVec fma(DoubleVec a, DoubleVec b, DoubleVec c)
+    {
+#ifdef XPREC_SIMD_FMA
+        return _mm_fmadd_pd(a._x, b._x, c._x);
+#else
+        double ta[2], tb[2], tc[2];
+        a.store(ta);
+        b.store(tb);
+        c.store(tc);
+        for (int i = 0; i != 2; ++i)
+            ta[i] = std::fma(ta[i], tb[i], tc[i]);
+        return load(ta);
+#endif
+    }
+
+    friend DoubleVec min(DoubleVec a, DoubleVec b)
+    {
+        return _mm_min_pd(a._x, b._x);
+    }
+    friend DoubleVec max(DoubleVec a, DoubleVec b)
+    {
+        return _mm_max_pd(a._x, b._x);
+    }
+
+    friend DoubleVec ldexp(DoubleVec x, DoubleVec k)
+    {
+        // Adding 2^52 + 1023 moves the biased exponent into the low bits of
+        // the mantissa, from where we shift it into the exponent field.
+        __m128i e = _mm_castpd_si128(
+            _mm_add_pd(k._x, _mm_set1_pd(4503599627371519.0)));
+        return _mm_mul_pd(x._x, _mm_castsi128_pd(_mm_slli_epi64(e, 52)));
+    }
+
+    friend DoubleVec logb(DoubleVec x)
+    {
+        // Conversely, moving the exponent field into the low bits of 2^52
+        // gives 2^52 plus the biased exponent.
+        const __m128i mask = _mm_set1_epi64x(0x7ff0000000000000);
+        __m128i e = _mm_and_si128(_mm_castpd_si128(x._x), mask);
+        e = _mm_or_si128(_mm_srli_epi64(e, 52),
+                         _mm_castpd_si128(_mm_set1_pd(4503599627370496.0)));
+        return _mm_sub_pd(_mm_castsi128_pd(e),
+                          _mm_set1_pd(4503599627371519.0));
+    }
+
+private:
+    __m128d _x;
+};
+
+#endif /* SSE2 */
+
+#if defined(__AVX__)
+
+template <>
+class DoubleVec<4> {
+public:
+    static constexpr int width = 4;
+
+    DoubleVec() = default;
+    DoubleVec(double x) : _x(_mm256_set1_pd(x)) { }
+    DoubleVec(__m256d x) : _x(x) { }
+
+    operator __m256d() const { return _x; }
+
+    static DoubleVec load(const double *p) { return _mm256_loadu_pd(p); }
+
+    static void load_pairs(const double *p, DoubleVec &even, DoubleVec &odd)
+    {
+        // a = [e0 o0 e1 o1], b = [e2 o2 e3 o3]
+        __m256d a = _mm256_loadu_pd(p);
+        __m256d b = _mm256_loadu_pd(p + 4);
+        __m256d lo = _mm256_permute2f128_pd(a, b, 0x20); // [e0 o0 e2 o2]
+        __m256d hi = _mm256_permute2f128_pd(a, b, 0x31); // [e1 o1 e3 o3]
+        even = _mm256_unpacklo_pd(lo, hi);
+        odd = _mm256_unpackhi_pd(lo, hi);
+    }
+
+    void store(double *p) const { _mm256_storeu_pd(p, _x); }
+
+    static void store_pairs(double *p, DoubleVec even, DoubleVec odd)
+    {
+        __m256d lo = _mm256_unpacklo_pd(even._x, odd._x); // [e0 o0 e2 o2]
+        __m256d hi = _mm256_unpackhi_pd(even._x, odd._x); // [e1 o1 e3 o3]
+        _mm256_storeu_pd(p, _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(p + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+
+    static DoubleVec gather(const double *base, DoubleVec index)
+    {
+#if defined(__AVX2__)
+        // The masked form with explicit source avoids a spurious
+        // -Wuninitialized from GCC's _mm256_i32gather_pd
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base,
+                                        _mm256_cvtpd_epi32(index._x), all, 8);
+#else
+        double tmp[4];
+        index.store(tmp);
+        for (int i = 0; i != 4; ++i)
+            tmp[i] = base[(int)tmp[i]];
+        return load(tmp);
+#endif
+    }
+
+    double operator[](int i) const
+    {
+        double tmp[4];
+        store(tmp);
+        return tmp[i];
+    }
+
+    friend DoubleVec operator+(DoubleVec a) { return a; }
+    friend DoubleVec operator-(DoubleVec a)
+    {
+        return _mm256_xor_pd(a._x, _mm256_set1_pd(-0.0));
+    }
+
+    friend DoubleVec operator+(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_add_pd(a._x, b._x);
+    }
+    friend DoubleVec operator-(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_sub_pd(a._x, b._x);
+    }
+    friend DoubleVec operator*(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_mul_pd(a._x, b._x);
+    }
+    friend DoubleVec operator/(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_div_pd(a._x, b._x);
+    }
+
+    friend DoubleVec fma(DoubleVec a, DoubleVec b, DoubleVec c)
+    {
+#ifdef XPREC_SIMD_FMA
+        return _mm256_fmadd_pd(a._x, b._x, c._x);
+#else
+        double ta[4], tb[4], tc[4];
+        a.store(ta);
+        b.store(tb);
+        c.store(tc);
+        for (int i = 0; i != 4; ++i)
+            ta[i] = std::fma(ta[i], tb[i], tc[i]);
+        return load(ta);
+#endif
+    }
+
+    friend DoubleVec min(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_min_pd(a._x, b._x);
+    }
+    friend DoubleVec max(DoubleVec a, DoubleVec b)
+    {
+        return _mm256_max_pd(a._x, b._x);
+    }
+
+    friend DoubleVec ldexp(DoubleVec x, DoubleVec k)
+    {
+#if defined(__AVX2__)
+        // See the SSE2 version
+        __m256i e = _mm256_castpd_si256(
+            _mm256_add_pd(k._x, _mm256_set1_pd(4503599627371519.0)));
+        return _mm256_mul_pd(x._x,
+                             _mm256_castsi256_pd(_mm256_slli_epi64(e, 52)));
+#else
+        double tx[4], tk[4];
+        x.store(tx);
+        k.store(tk);
+        for (int i = 0; i != 4; ++i)
+            tx[i] = std::ldexp(tx[i], (int)tk[i]);
+        return load(tx);
+#endif
+    }
+
+    friend DoubleVec logb(DoubleVec x)
+    {
+#if defined(__AVX2__)
+        // See the SSE2 version
+        const __m256i mask = _mm256_set1_epi64x(0x7ff0000000000000);
+        __m256i e = _mm256_and_si256(_mm256_castpd_si256(x._x), mask);
+        e = _mm256_or_si256(
+            _mm256_srli_epi64(e, 52),
+            _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)));
+        return _mm256_sub_pd(_mm256_castsi256_pd(e),
+                             _mm256_set1_pd(4503599627371519.0));
+#else
+        double tx[4];
+        x.store(tx);
+        for (int i = 0; i != 4; ++i)
+            tx[i] = std::logb(tx[i]);
+        return load(tx);
+#endif
+    }
+
+private:
+    __m256d _x;
+};
+
+#endif /* AVX */
+
+#if defined(__AVX512F__)
+
+template <>
+class DoubleVec<8> {
+public:
+    static constexpr int width = 8;
+
+    DoubleVec() = default;
+    DoubleVec(double x) : _x(_mm512_set1_pd(x)) { }
+    DoubleVec(__m512d x) : _x(x) { }
+
+    operator __m512d() const { return _x; }
+
+    static DoubleVec load(const double *p) { return _mm512_loadu_pd(p); }
+
+    static void load_pairs(const double *p, DoubleVec &even, DoubleVec &odd)
+    {
+        const __m512i even_idx = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+        const __m512i odd_idx = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+        __m512d a = _mm512_loadu_pd(p);
+        __m512d b = _mm512_loadu_pd(p + 8);
+        even = _mm512_permutex2var_pd(a, even_idx, b);
+        odd = _mm512_permutex2var_pd(a, odd_idx, b);
+    }
+
+    void store(double *p) const { _mm512_storeu_pd(p, _x); }
+
+    static void store_pairs(double *p, DoubleVec even, DoubleVec odd)
+    {
+        const __m512i lo_idx = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+        const __m512i hi_idx = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+        _mm512_storeu_pd(p, _mm512_permutex2var_pd(even._x, lo_idx, odd._x));
+        _mm512_storeu_pd(p + 8,
+                         _mm512_permutex2var_pd(even._x, hi_idx, odd._x));
+    }
+
+    static DoubleVec gather(const double *base, DoubleVec index)
+    {
+        return _mm512_i32gather_pd(_mm512_cvtpd_epi32(index._x), base, 8);
+    }
+
+    double operator[](int i) const
+    {
+        double tmp[8];
+        store(tmp);
+        return tmp[i];
+    }
+
+    friend DoubleVec operator+(DoubleVec a) { return a; }
+    friend DoubleVec operator-(DoubleVec a)
+    {
+        // _mm512_xor_pd requires AVX512DQ, so flip the sign bit as integer
+        return _mm512_castsi512_pd(
+            _mm512_xor_si512(_mm512_castpd_si512(a._x),
+                             _mm512_set1_epi64(INT64_MIN)));
+    }
+
+    friend DoubleVec operator+(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_add_pd(a._x, b._x);
+    }
+    friend DoubleVec operator-(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_sub_pd(a._x, b._x);
+    }
+    friend DoubleVec operator*(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_mul_pd(a._x, b._x);
+    }
+    friend DoubleVec operator/(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_div_pd(a._x, b._x);
+    }
+
+    friend DoubleVec fma(DoubleVec a, DoubleVec b, DoubleVec c)
+    {
+        // AVX-512F always includes FMA
+        return _mm512_fmadd_pd(a._x, b._x, c._x);
+    }
+
+    friend DoubleVec min(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_min_pd(a._x, b._x);
+    }
+    friend DoubleVec max(DoubleVec a, DoubleVec b)
+    {
+        return _mm512_max_pd(a._x, b._x);
+    }
+
+    friend DoubleVec ldexp(DoubleVec x, DoubleVec k)
+    {
+        return _mm512_scalef_pd(x._x, k._x);
+    }
+
+    friend DoubleVec logb(DoubleVec x) { return _mm512_getexp_pd(x._x); }
+
+private:
+    __m512d _x;
+};
+
+#endif /* AVX512F */
+
+} /* namespace xprec */
@@ -0,0 +1,86 @@
+/* Small double-double arithmetic library - linear systems
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "ddouble.h"
+
+namespace xprec {
+
+/**
+ * Solver for linear systems A x = b by mixed-precision iterative refinement.
+ *
+ * Factorizing A directly in double-double arithmetic costs O(n^3) operations
+ * which are each about ten times as expensive as in double.  Instead, this
+ * class factorizes A only once in double precision.  solve() then repeats the
+ * following refinement step: compute the residual r = b - A x in double-double
+ * arithmetic, solve A d = r in double precision using the factorization, and
+ * update x += d.  Each step only costs O(n^2) operations and reduces the error
+ * by a factor of about cond(A) u, so the solution usually reaches
+ * double-double accuracy in two or three steps, as long as the condition
+ * number cond(A) of A is well below 1/u ~ 1e16 [^1].
+ *
+ * [^1]: J. Langou et al., Proc. 2006 ACM/IEEE Conf. on Supercomputing (2006)
+ */
+class RefinedSolver {
+public:
+    /** Factorization of A in double precision */
+    enum Method {
+        /** LU decomposition with partial pivoting for general matrices */
+        LU,
+        /** Cholesky decomposition for symmetric positive definite matrices */
+        CHOLESKY
+    };
+
+    /**
+     * Factorize the n x n matrix A, stored in column-major order with leading
+     * dimension lda.
+     *
+     * A is copied, so it need not outlive the solver.  For CHOLESKY, only the
+     * lower triangle of A is referenced.  If the factorization breaks down,
+     * i.e., if A.hi() is singular or not positive definite, ok() is false.
+     */
+    RefinedSolver(size_t n, const DDouble *a, size_t lda, Method method = LU);
+
+    /** Dimension of the system */
+    size_t size() const { return _n; }
+
+    /** True if the factorization succeeded */
+    bool ok() const { return _ok; }
+
+    /**
+     * Solve A x = b, where x and b are arrays of size n.
+     *
+     * Returns the number of refinement steps performed, or -1 if the
+     * refinement did not converge within max_steps, e.g., because A is too
+     * ill-conditioned.  In this case, x holds the last iterate, or NaN if
+     * the factorization had failed.
+     */
+    int solve(const DDouble *b, DDouble *x, int max_steps = 10) const;
+
+private:
+    size_t _n;
+    Method _method;
+    bool _ok;
+    double _norm;
+    std::vector<DDouble> _a;
+    std::vector<double> _f;
+    std::vector<size_t> _piv;
+};
+
+/**
+ * Solve the n x n linear system A x = b in double-double precision.
+ *
+ * Shortcut for RefinedSolver(n, a, lda).solve(b, x): A is stored in
+ * column-major order with leading dimension lda, LU-factorized in double and
+ * the solution is refined in double-double arithmetic.  Returns the number of
+ * refinement steps, or -1 if the solution did not converge.
+ */
+int solve(size_t n, const DDouble *a, size_t lda, const DDouble *b,
+          DDouble *x);
+
+} /* namespace xprec */
@@ -0,0 +1,264 @@
+/* Small double-double arithmetic library - quadrature rules
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "array.h"
+#include "ddouble.h"
+
+namespace xprec {
+
+/**
+ * Quadrature rule: nodes x[i] and weights w[i] for i = 0, ..., size()-1.
+ *
+ * Rules handed out by QuadratureCache are shared between threads and thus
+ * immutable.
+ */
+class QuadratureRule {
+public:
+    /** Construct rule from nodes and weights, which must have equal size */
+    QuadratureRule(std::vector<DDouble> x, std::vector<DDouble> w);
+
+    /** Number of nodes */
+    size_t size() const { return _x.size(); }
+
+    /** Pointer to the nodes */
+    const DDouble *x() const { return _x.data(); }
+
+    /** Pointer to the weights */
+    const DDouble *w() const { return _w.data(); }
+
+    /** Memory used by nodes and weights in bytes */
+    size_t bytes() const { return 2 * size() * sizeof(DDouble); }
+
+private:
+    std::vector<DDouble> _x, _w;
+};
+
+/**
+ * Thread-safe registry of quadrature rules, keyed by family and order.
+ *
+ * The first request for a rule computes it and stores it in the cache, and
+ * every further request for the same rule only costs a lookup, which does not
+ * take any locks.  Rules are never evicted, which keeps lookups lock-free.
+ * Instead, the memory footprint is bounded by refusing to store more than
+ * max_rules rules or max_bytes bytes: any further rule is computed anew on
+ * each request.  If several threads request the same missing rule at the same
+ * time, only one of them computes it, while the others wait for the result.
+ *
+ * Usually, you want to use the process-wide instance global(), e.g., through
+ * gauss_legendre_rule().
+ */
+class QuadratureCache {
+public:
+    /** Family of quadrature rules */
+    enum Family {
+        /** Gauss-Chebyshev rule, see gauss_chebyshev() */
+        GAUSS_CHEBYSHEV,
+        /** Gauss-Legendre rule, see gauss_legendre() */
+        GAUSS_LEGENDRE
+    };
+
+    /** Construct empty cache with the given limits */
+    explicit QuadratureCache(size_t max_bytes = size_t(256) << 20,
+                             size_t max_rules = 1024);
+
+    ~QuadratureCache();
+
+    QuadratureCache(const QuadratureCache &) = delete;
+    QuadratureCache &operator=(const QuadratureCache &) = delete;
+
+    /** Get the rule of given family and order n >= 1, nullptr if n < 1 */
+    std::shared_ptr<const QuadratureRule> get(Family family, int n);
+
+    /** Number of rules stored */
+    size_t size() const { return _rules.load(std::memory_order_relaxed); }
+
+    /** Memory used by the rules stored in bytes */
+    size_t bytes() const { return _bytes.load(std::memory_order_relaxed); }
+
+    /** Process-wide cache instance */
+    static QuadratureCache &global();
+
+private:
+    struct Entry;
+    struct Pending;
+
+    const Entry *find(Family family, int n) const;
+    void remove_pending(Family family, int n);
+
+    size_t _max_bytes, _max_rules, _mask;
+    std::unique_ptr<std::atomic<const Entry *>[]> _slots;
+    std::atomic<size_t> _rules, _bytes;
+    std::mutex _insert_mutex;
+    std::vector<std::shared_ptr<Pending>> _pending;
+};
+
+/**
+ * Compute the rule of given family and order n >= 1 without any caching.
+ *
+ * Returns nullptr if n < 1.
+ */
+std::shared_ptr<const QuadratureRule> make_rule(QuadratureCache::Family family,
+                                                int n);
+
+/** Gauss-Legendre rule of order n from the global cache */
+std::shared_ptr<const QuadratureRule> gauss_legendre_rule(int n);
+
+/** Gauss-Chebyshev rule of order n from the global cache */
+std::shared_ptr<const QuadratureRule> gauss_chebyshev_rule(int n);
+
+/**
+ * Composite Gauss-Legendre rule on a grid of segments.
+ *
+ * Maps the Gauss-Legendre rule of given order from the global cache onto
+ * every segment [a, b] = [edges[s], edges[s+1]], where the edges must be
+ * non-decreasing.  The nodes of segment s are those with indices
+ * offsets()[s], ..., offsets()[s+1]-1.  Nodes and weights are stored in
+ * structure-of-arrays layout (see DDoubleArray), and built in a single pass.
+ *
+ * Besides the nodes x, the distances x - a and b - x to the edges of the
+ * segment are stored.  These are computed from the half-width of the segment
+ * rather than from x, so they are accurate to double-double precision
+ * relative to the segment width even if the segment is tiny compared to its
+ * position.  Integrands with a singularity or rapid variation at a segment
+ * edge should be expressed in terms of them.
+ */
+class CompositeRule {
+public:
+    /** Construct rule of given order >= 1 on the nedges - 1 segments */
+    CompositeRule(const DDouble *edges, size_t nedges, int order);
+
+    /** Construct rule of given order >= 1 on the segments between edges */
+    CompositeRule(const std::vector<DDouble> &edges, int order)
+        : CompositeRule(edges.data(), edges.size(), order)
+    { }
+
+    /** Order of the Gauss-Legendre rule on each segment */
+    int order() const { return _order; }
+
+    /** Number of segments */
+    size_t segments() const { return _offsets.size() - 1; }
+
+    /** Total number of nodes */
+    size_t size() const { return _x.size(); }
+
+    /** Offsets of the segments into the nodes, of size segments() + 1 */
+    const size_t *offsets() const { return _offsets.data(); }
+
+    /** Nodes, in ascending order */
+    const DDoubleArray &x() const { return _x; }
+
+    /** Weights */
+    const DDoubleArray &w() const { return _w; }
+
+    /** Distance x - a of each node to the lower edge of its segment */
+    const DDoubleArray &x_minus_a() const { return _x_minus_a; }
+
+    /** Distance b - x of each node to the upper edge of its segment */
+    const DDoubleArray &b_minus_x() const { return _b_minus_x; }
+
+private:
+    int _order;
+    std::vector<size_t> _offsets;
+    DDoubleArray _x, _w, _x_minus_a, _b_minus_x;
+};
+
+/**
+ * Read-only view of a quadrature rule in structure-of-arrays layout.
+ *
+ * The hi and lo parts of nodes and weights are stored in separate arrays, as
+ * in DDoubleArray.  An empty view (size() == 0) signals a missing rule.
+ */
+struct QuadratureRuleView {
+    size_t n;
+    const double *x_hi, *x_lo, *w_hi, *w_lo;
+
+    /** Number of nodes */
+    size_t size() const { return n; }
+
+    /** i-th node */
+    DDouble x(size_t i) const { return DDouble(x_hi[i], x_lo[i]); }
+
+    /** i-th weight */
+    DDouble w(size_t i) const { return DDouble(w_hi[i], w_lo[i]); }
+};
+
+/**
+ * Quadrature rules stored in a file, which is mapped into memory.
+ *
+ * The file is created by save_rules() or the xprec-rules tool.  It starts
+ * with a header, which contains a magic string, the format version and a
+ * byte order mark, followed by a table of the rules sorted by family and
+ * order.  The nodes and weights of each rule follow as four aligned arrays
+ * of doubles: x_hi, x_lo, w_hi, w_lo.
+ *
+ * Since these arrays are in native layout, they are used directly from the
+ * mapped pages without any parsing or copying, and processes on the same
+ * machine which map the same file share its pages.  Only the header and
+ * table are validated when the file is loaded.
+ */
+class MappedRules {
+public:
+    /**
+     * Map the file at path into memory.
+     *
+     * If the file cannot be read, or has the wrong format, version or byte
+     * order, ok() is false and the object holds no rules.
+     */
+    explicit MappedRules(const std::string &path);
+
+    ~MappedRules();
+
+    MappedRules(const MappedRules &) = delete;
+    MappedRules &operator=(const MappedRules &) = delete;
+
+    /** True if the file was loaded successfully */
+    bool ok() const { return _ok; }
+
+    /** Number of rules in the file */
+    size_t size() const { return _count; }
+
+    /** Find rule of given family and order, return empty view if absent */
+    QuadratureRuleView find(QuadratureCache::Family family, int n) const;
+
+    /** Version of the file format written by save_rules() */
+    static const unsigned VERSION = 1;
+
+private:
+    void unmap();
+
+    const unsigned char *_data;
+    size_t _length;
+    bool _mapped, _ok;
+    size_t _count;
+    std::vector<double> _buffer;
+};
+
+/**
+ * Load quadrature rules from the file at path (see MappedRules).
+ *
+ * Returns nullptr if the file cannot be read or has the wrong format.
+ */
+std::shared_ptr<const MappedRules> load_rules(const std::string &path);
+
+/**
+ * Compute rules of the given family for the count orders in n and write them
+ * to the file at path, which can then be loaded with load_rules().
+ *
+ * The rules are written to a temporary file next to path, which then replaces
+ * path, so processes which have the old file mapped are not affected.
+ * Returns false if any order is less than 1 or the file cannot be written.
+ */
+bool save_rules(const std::string &path, QuadratureCache::Family family,
+                const int *n, size_t count);
+
+} /* namespace xprec */
@@ -0,0 +1,637 @@
+/* Small double-double arithmetic library - explicit SIMD module
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cmath>
+
+#include "ddouble.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(__AVX__) ||              \
+    defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Hardware FMA instruction for packed doubles.  MSVC does not define __FMA__,
+// but every CPU with AVX2 also has FMA.  Like the scalar code, the packs only
+// use FMA for products if XPREC_FMA is set (see ddouble.h).
+#if XPREC_FMA && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define XPREC_SIMD_FMA 1
+#endif
+
+// Natural pack width for the instruction set we are compiling for.
+#if defined(__AVX512F__)
+#define XPREC_SIMD_WIDTH 8
+#elif defined(__AVX__)
+#define XPREC_SIMD_WIDTH 4
+#else
+#define XPREC_SIMD_WIDTH 2
+#endif
+
+namespace xprec {
+
+template <int N>
+class DoubleVec;
+template <int N>
+class ExDoubleVec;
+template <int N>
+class DDoubleVec;
+
+/**
+ * Pack of N doubles processed in lock-step.
+ *
+ * This generic version is a plain array with element-wise loops, which
+ * serves as fallback for any N.  Specializations for N = 2 (SSE2), 4 (AVX2)
+ * and 8 (AVX-512) map directly to vector registers if the instruction set is
+ * enabled at compile time.
+ *
+ * All loads and stores are unaligned.
+ */
+template <int N>
+class DoubleVec {
+public:
+    static_assert(N > 0, "invalid pack width");
+
+    static constexpr int width = N;
+
+    DoubleVec() = default;
+
+    /** Broadcast x to all lanes */
+    DoubleVec(double x)
+    {
+        for (int i = 0; i != N; ++i)
+            _x[i] = x;
+    }
+
+    /** Load N consecutive doubles from memory */
+    static DoubleVec load(const double *p)
+    {
+        DoubleVec r;
+        for (int i = 0; i != N; ++i)
+            r._x[i] = p[i];
+        return r;
+    }
+
+    /** Load 2*N doubles from memory, splitting even and odd elements */
+    static void load_pairs(const double *p, DoubleVec &even, DoubleVec &odd)
+    {
+        for (int i = 0; i != N; ++i) {
+            even._x[i] = p[2 * i];
+            odd._x[i] = p[2 * i + 1];
+        }
+    }
+
+    /** Store N consecutive doubles to memory */
+    void store(double *p) const
+    {
+        for (int i = 0; i != N; ++i)
+            p[i] = _x[i];
+    }
+
+    /** Store 2*N doubles to memory, interleaving even and odd elements */
+    static void store_pairs(double *p, DoubleVec even, DoubleVec odd)
+    {
+        for (int i = 0; i != N; ++i) {
+            p[2 * i] = even._x[i];
+            p[2 * i + 1] = odd._x[i];
+        }
+    }
+
+    /**
+     * Gather N doubles from memory: lane i is set to base[index[i]].
+     *
+     * WARNING: Lanes of index MUST be non-negative integers (as doubles)
+     * that address valid elements of base.
+     */
+    static DoubleVec gather(const double *base, DoubleVec index)
+    {
+        DoubleVec r;
+        for (int i = 0; i != N; ++i)
+            r._x[i] = base[(int)index._x[i]];
+        return r;
+    }
+
+    /** Get i-th lane */
+    double operator[](int i) const { return _x[i]; }
+
+    friend DoubleVec operator+(DoubleVec a) { return a; }
+    friend DoubleVec operator-(DoubleVec a)
+    {
+        return elementwise(a, a, [](double x, double) { return -x; });
+    }
+
+    friend DoubleVec operator+(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b, [](double x, double y) { return x + y; });
+    }
+    friend DoubleVec operator-(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b, [](double x, double y) { return x - y; });
+    }
+    friend DoubleVec operator*(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b, [](double x, double y) { return x * y; });
+    }
+    friend DoubleVec operator/(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b, [](double x, double y) { return x / y; });
+    }
+
+    /** Fused multiply-add a * b + c with a single rounding */
+    friend DoubleVec fma(DoubleVec a, DoubleVec b, DoubleVec c)
+    {
+        DoubleVec r;
+        for (int i = 0; i != N; ++i)
+            r._x[i] = std::fma(a._x[i], b._x[i], c._x[i]);
+        return r;
+    }
+
+    /** Lane-wise minimum.  If either lane is NaN, returns the lane of b. */
+    friend DoubleVec min(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b,
+                           [](double x, double y) { return x < y ? x : y; });
+    }
+
+    /** Lane-wise maximum.  If either lane is NaN, returns the lane of b. */
+    friend DoubleVec max(DoubleVec a, DoubleVec b)
+    {
+        return elementwise(a, b,
+                           [](double x, double y) { return x > y ? x : y; });
+    }
+
+    /**
+     * Multiply lanes of x by 2^k, see std::ldexp.
+     *
+     * WARNING: Lanes of k MUST be integers (as doubles) between -1022 and
+     * 1023, i.e., 2^k must be a normal number.
+     */
+    friend DoubleVec ldexp(DoubleVec x, DoubleVec k)
+    {
+        return elementwise(x, k, [](double a, double b) {
+            return std::ldexp(a, (int)b);
+        });
+    }
+
+    /**
+     * Exponent floor(log2(abs(x))) of lanes as doubles, see std::logb.
+     *
+     * WARNING: Lanes of x MUST be normal numbers, i.e., not zero, subnormal,
+     * infinite or NaN.
+     */
+    friend DoubleVec logb(DoubleVec x)
+    {
+        return elementwise(x, x,
+                           [](double a, double) { return std::logb(a); });
+    }
+
+private:
+    template <typename Op>
+    static DoubleVec elementwise(DoubleVec a, DoubleVec b, Op op)
+    {
+        DoubleVec r;
+        for (int i = 0; i != N; ++i)
+            r._x[i] = op(a._x[i], b._x[i]);
+        return r;
+    }
+
+    double _x[N];
+};
+
+namespace _internal {
+
+/** Veltkamp splitting for packs, see the scalar version */
+template <int N>
+inline void veltkamp_split(DoubleVec<N> a, DoubleVec<N> &hi, DoubleVec<N> &lo)
+{
+    // To avoid overflow, lanes above 2^996 in magnitude are scaled by 2^-28.
+    // m is 1 for those lanes and 0 otherwise: the difference to 2^996 is
+    // either zero or at least 2^944, which overflows when multiplied by 2^80.
+    const double factor = 134217729.0; // 2^27 + 1
+    const double big = 6.696928794914171e+299; // 2^996
+    DoubleVec<N> abs_a = max(a, -a);
+    DoubleVec<N> m = min(max(abs_a - big, 0.0) * 1.2089258196146292e+24, 1.0);
+    DoubleVec<N> down = 1.0 - m * 0.9999999962747097; // 1 or 2^-28
+    DoubleVec<N> up = 1.0 + m * 268435455.0; // 1 or 2^28
+
+    DoubleVec<N> as = a * down;
+    DoubleVec<N> c = factor * as;
+    DoubleVec<N> h = c - (c - as);
+    hi = h * up;
+    lo = (as - h) * up;
+}
+
+/** Error-free product for packs using Dekker's algorithm */
+template <int N>
+inline DoubleVec<N> two_prod_dekker(DoubleVec<N> a, DoubleVec<N> b,
+                                    DoubleVec<N> &e)
+{
+    DoubleVec<N> p = a * b;
+    DoubleVec<N> a_hi, a_lo, b_hi, b_lo;
+    veltkamp_split(a, a_hi, a_lo);
+    veltkamp_split(b, b_hi, b_lo);
+    e = (((a_hi * b_hi - p) + a_hi * b_lo) + a_lo * b_hi) + a_lo * b_lo;
+    return p;
+}
+
+/** Error-free product for packs (see XPREC_FMA) */
+template <int N>
+inline DoubleVec<N> two_prod(DoubleVec<N> a, DoubleVec<N> b, DoubleVec<N> &e)
+{
+#if XPREC_FMA
+    DoubleVec<N> p = a * b;
+    e = fma(a, b, -p);
+    return p;
+#else
+    return two_prod_dekker(a, b, e);
+#endif
+}
+
+/** Compute a * b + c with a single rounding (see XPREC_FMA) */
+template <int N>
+inline DoubleVec<N> mul_add(DoubleVec<N> a, DoubleVec<N> b, DoubleVec<N> c)
+{
+#if XPREC_FMA
+    return fma(a, b, c);
+#else
+    // See the scalar version
+    DoubleVec<N> e;
+    DoubleVec<N> p = two_prod_dekker(a, b, e);
+    DoubleVec<N> s = p + c;
+    DoubleVec<N> p_prime = s - c;
+    DoubleVec<N> c_prime = s - p_prime;
+    DoubleVec<N> t = (p - p_prime) + (c - c_prime);
+    return s + (t + e);
+#endif
+}
+
+/** Compute a * b + c with a single rounding, where c + a * b cancels */
+template <int N>
+inline DoubleVec<N> mul_add_cancel(DoubleVec<N> a, DoubleVec<N> b,
+                                   DoubleVec<N> c)
+{
+#if XPREC_FMA
+    return fma(a, b, c);
+#else
+    DoubleVec<N> e;
+    DoubleVec<N> p = two_prod_dekker(a, b, e);
+    return (c + p) + e;
+#endif
+}
+
+} /* namespace _internal */
+
+/**
+ * Pack of N doubles, marked for extended precision computation.
+ *
+ * This is the SIMD analogue of ExDouble: arithmetic on these objects yields
+ * a DDoubleVec using the error-free transformations (two_sum, two_prod).
+ */
+template <int N>
+class ExDoubleVec {
+public:
+    ExDoubleVec(DoubleVec<N> x) : _x(x) { }
+
+    operator DoubleVec<N>() const { return _x; }
+
+    /**
+     * Add small number to this.
+     *
+     * WARNING: You must ensure that b is small than this in magnitude!
+     */
+    DDoubleVec<N> add_small(DoubleVec<N> b) const
+    {
+        // Algorithm 1: cost 3 flops
+        DoubleVec<N> s = _x + b;
+        DoubleVec<N> z = s - _x;
+        DoubleVec<N> t = b - z;
+        return DDoubleVec<N>(s, t);
+    }
+
+    DDoubleVec<N> add_small(DDoubleVec<N> b) const
+    {
+        // Algorithm 4 modified: cost 7 flops, error 2 u^2
+        DDoubleVec<N> s = add_small(b.hi());
+        DoubleVec<N> v = b.lo() + s.lo();
+        return ExDoubleVec(s.hi()).add_small(v);
+    }
+
+    friend DDoubleVec<N> operator+(ExDoubleVec a, ExDoubleVec b)
+    {
+        // Algorithm 2: cost 6 flops
+        DoubleVec<N> s = a._x + b._x;
+        DoubleVec<N> aprime = s - b._x;
+        DoubleVec<N> bprime = s - aprime;
+        DoubleVec<N> delta_a = a._x - aprime;
+        DoubleVec<N> delta_b = b._x - bprime;
+        DoubleVec<N> t = delta_a + delta_b;
+        return DDoubleVec<N>(s, t);
+    }
+
+    friend DDoubleVec<N> operator+(ExDoubleVec a, DoubleVec<N> b)
+    {
+        return a + ExDoubleVec(b);
+    }
+    friend DDoubleVec<N> operator+(DoubleVec<N> a, ExDoubleVec b)
+    {
+        return ExDoubleVec(a) + b;
+    }
+
+    friend DDoubleVec<N> operator-(ExDoubleVec a, ExDoubleVec b)
+    {
+        return a + ExDoubleVec(-b._x);
+    }
+    friend DDoubleVec<N> operator-(ExDoubleVec a, DoubleVec<N> b)
+    {
+        return a + ExDoubleVec(-b);
+    }
+    friend DDoubleVec<N> operator-(DoubleVec<N> a, ExDoubleVec b)
+    {
+        return ExDoubleVec(a) + ExDoubleVec(-b._x);
+    }
+
+    friend DDoubleVec<N> operator*(ExDoubleVec a, ExDoubleVec b)
+    {
+        // Algorithm 3: cost 2 flops
+        DoubleVec<N> rho;
+        DoubleVec<N> pi = _internal::two_prod(a._x, b._x, rho);
+        return DDoubleVec<N>(pi, rho);
+    }
+    friend DDoubleVec<N> operator*(ExDoubleVec a, DoubleVec<N> b)
+    {
+        return a * ExDoubleVec(b);
+    }
+    friend DDoubleVec<N> operator*(DoubleVec<N> a, ExDoubleVec b)
+    {
+        return ExDoubleVec(a) * b;
+    }
+
+    friend DDoubleVec<N> reciprocal(ExDoubleVec y)
+    {
+        // Part of Algorithm 18 for y_lo = 0
+        DoubleVec<N> th = DoubleVec<N>(1.0) / y._x;
+        DoubleVec<N> rh =
+            _internal::mul_add_cancel(-y._x, th, DoubleVec<N>(1.0));
+        DDoubleVec<N> delta = ExDoubleVec(rh) * th;
+        return delta + th;
+    }
+
+    friend DDoubleVec<N> operator/(ExDoubleVec a, ExDoubleVec b)
+    {
+        // Algorithm 18 for this special case
+        return reciprocal(b) * a._x;
+    }
+    friend DDoubleVec<N> operator/(ExDoubleVec a, DoubleVec<N> b)
+    {
+        return a / ExDoubleVec(b);
+    }
+    friend DDoubleVec<N> operator/(DoubleVec<N> a, ExDoubleVec b)
+    {
+        return ExDoubleVec(a) / b;
+    }
+
+private:
+    DoubleVec<N> _x;
+};
+
+/**
+ * Pack of N double-double numbers processed in lock-step.
+ *
+ * Mirrors the arithmetic of DDouble lane by lane: each lane executes exactly
+ * the same sequence of floating-point operations as the scalar algorithms, so
+ * the results agree with those of DDouble (up to the compiler contracting
+ * scalar operations into FMAs).
+ *
+ * Packs can be loaded from and stored to either the structure-of-arrays
+ * layout (separate hi and lo planes, as in DDoubleArray) or the interleaved
+ * layout of an array of DDouble.
+ */
+template <int N = XPREC_SIMD_WIDTH>
+class DDoubleVec {
+public:
+    static constexpr int width = N;
+
+    DDoubleVec() = default;
+
+    /** Broadcast x to all lanes */
+    DDoubleVec(DDouble x) : _hi(x.hi()), _lo(x.lo()) { }
+
+    /** Promote pack of doubles */
+    DDoubleVec(DoubleVec<N> x) : _hi(x), _lo(0.0) { }
+
+    /**
+     * Construct from hi and lo parts.
+     *
+     * WARNING: You MUST ensure that abs(hi) > epsilon * abs(lo).
+     */
+    DDoubleVec(DoubleVec<N> hi, DoubleVec<N> lo) : _hi(hi), _lo(lo) { }
+
+    /** Load N consecutive elements from separate hi and lo planes */
+    static DDoubleVec load(const double *hi, const double *lo)
+    {
+        return DDoubleVec(DoubleVec<N>::load(hi), DoubleVec<N>::load(lo));
+    }
+
+    /** Load N consecutive elements from array of DDouble */
+    static DDoubleVec load(const DDouble *x)
+    {
+        DDoubleVec r;
+        DoubleVec<N>::load_pairs(reinterpret_cast<const double *>(x), r._hi,
+                                 r._lo);
+        return r;
+    }
+
+    /** Store N consecutive elements to separate hi and lo planes */
+    void store(double *hi, double *lo) const
+    {
+        _hi.store(hi);
+        _lo.store(lo);
+    }
+
+    /** Store N consecutive elements to array of DDouble */
+    void store(DDouble *x) const
+    {
+        DoubleVec<N>::store_pairs(reinterpret_cast<double *>(x), _hi, _lo);
+    }
+
+    /**
+     * Gather N elements from a table: lane i is set to table[index[i]].
+     *
+     * WARNING: Lanes of index MUST be non-negative integers (as doubles)
+     * that address valid elements of table.
+     */
+    static DDoubleVec gather(const DDouble *table, DoubleVec<N> index)
+    {
+        const double *base = reinterpret_cast<const double *>(table);
+        DoubleVec<N> offset = index + index;
+        return DDoubleVec(DoubleVec<N>::gather(base, offset),
+                          DoubleVec<N>::gather(base + 1, offset));
+    }
+
+    /** Get i-th lane */
+    DDouble operator[](int i) const { return DDouble(_hi[i], _lo[i]); }
+
+    /** Get high parts */
+    DoubleVec<N> hi() const { return _hi; }
+
+    /** Get low parts */
+    DoubleVec<N> lo() const { return _lo; }
+
+    /**
+     * Add small number to this.
+     *
+     * WARNING: You must ensure that b is small than this in magnitude!
+     */
+    DDoubleVec add_small(DoubleVec<N> y) const
+    {
+        // Algorithm 4 modified: cost 7 flops, error 2 u^2
+        DDoubleVec s = ExDoubleVec<N>(_hi).add_small(y);
+        DoubleVec<N> v = _lo + s._lo;
+        return ExDoubleVec<N>(s._hi).add_small(v);
+    }
+
+    /**
+     * Add small number to this.
+     *
+     * WARNING: You must ensure that b is small than this in magnitude!
+     */
+    DDoubleVec add_small(DDoubleVec y) const
+    {
+        // Algorithm 6: cost 17 flops, error 3 u^2 + 13 u^3
+        DDoubleVec s = ExDoubleVec<N>(_hi).add_small(y._hi);
+        DDoubleVec t = ExDoubleVec<N>(_lo) + y._lo;
+        DoubleVec<N> c = s._lo + t._hi;
+        DDoubleVec v = ExDoubleVec<N>(s._hi).add_small(c);
+        DoubleVec<N> w = t._lo + v._lo;
+        return ExDoubleVec<N>(v._hi).add_small(w);
+    }
+
+    friend DDoubleVec operator+(DDoubleVec x) { return x; }
+    friend DDoubleVec operator-(DDoubleVec x)
+    {
+        return DDoubleVec(-x._hi, -x._lo);
+    }
+
+    friend DDoubleVec operator+(DDoubleVec x, DoubleVec<N> y)
+    {
+        // Algorithm 4: cost 10 flops, error 2 u^2
+        DDoubleVec s = ExDoubleVec<N>(x._hi) + y;
+        DoubleVec<N> v = x._lo + s._lo;
+        return ExDoubleVec<N>(s._hi).add_small(v);
+    }
+
+    friend DDoubleVec operator+(DDoubleVec x, DDoubleVec y)
+    {
+        // Algorithm 6: cost 20 flops, error 3 u^2 + 13 u^3
+        DDoubleVec s = ExDoubleVec<N>(x._hi) + y._hi;
+        DDoubleVec t = ExDoubleVec<N>(x._lo) + y._lo;
+        DoubleVec<N> c = s._lo + t._hi;
+        DDoubleVec v = ExDoubleVec<N>(s._hi).add_small(c);
+        DoubleVec<N> w = t._lo + v._lo;
+        return ExDoubleVec<N>(v._hi).add_small(w);
+    }
+
+    friend DDoubleVec operator+(DoubleVec<N> x, DDoubleVec y) { return y + x; }
+
+    friend DDoubleVec operator-(DDoubleVec x, DoubleVec<N> y)
+    {
+        return x + (-y);
+    }
+    friend DDoubleVec operator-(DoubleVec<N> x, DDoubleVec y)
+    {
+        return (-y) + x;
+    }
+    friend DDoubleVec operator-(DDoubleVec x, DDoubleVec y)
+    {
+        return x + (-y);
+    }
+
+    friend DDoubleVec operator*(DDoubleVec x, DoubleVec<N> y)
+    {
+        // Algorithm 9: cost 6 flops, error 2 u^2
+        DDoubleVec c = ExDoubleVec<N>(x._hi) * y;
+        DoubleVec<N> cl3 = _internal::mul_add(x._lo, y, c._lo);
+        return ExDoubleVec<N>(c._hi).add_small(cl3);
+    }
+
+    friend DDoubleVec operator*(DDoubleVec x, DDoubleVec y)
+    {
+        // Algorithm 12: cost 9 flops, error 4 u^2 (corrected)
+        DDoubleVec c = ExDoubleVec<N>(x._hi) * y._hi;
+        DoubleVec<N> tl0 = x._lo * y._lo;
+        DoubleVec<N> tl1 = _internal::mul_add(x._hi, y._lo, tl0);
+        DoubleVec<N> cl2 = _internal::mul_add(x._lo, y._hi, tl1);
+        DoubleVec<N> cl3 = c._lo + cl2;
+        return ExDoubleVec<N>(c._hi).add_small(cl3);
+    }
+
+    friend DDoubleVec operator*(DoubleVec<N> x, DDoubleVec y) { return y * x; }
+
+    friend DDoubleVec operator*(DDoubleVec x, PowerOfTwo y)
+    {
+        // exact
+        return DDoubleVec(x._hi * (double)y, x._lo * (double)y);
+    }
+
+    friend DDoubleVec operator*(PowerOfTwo x, DDoubleVec y) { return y * x; }
+
+    /**
+     * Multiply lanes of x by 2^k.
+     *
+     * WARNING: Lanes of k MUST be integers between -1022 and 1023.
+     */
+    friend DDoubleVec ldexp(DDoubleVec x, DoubleVec<N> k)
+    {
+        return DDoubleVec(ldexp(x._hi, k), ldexp(x._lo, k));
+    }
+
+    friend DDoubleVec operator/(DDoubleVec x, DoubleVec<N> y)
+    {
+        // Algorithm 15: cost 10 flops, error 3 u^2
+        DoubleVec<N> th = x._hi / y;
+        DDoubleVec pi = ExDoubleVec<N>(th) * y;
+        DoubleVec<N> delta_h = x._hi - pi._hi;
+        DoubleVec<N> delta_tee = delta_h - pi._lo;
+        DoubleVec<N> delta = delta_tee + x._lo;
+        DoubleVec<N> tl = delta / y;
+        return ExDoubleVec<N>(th).add_small(tl);
+    }
+
+    friend DDoubleVec reciprocal(DDoubleVec y)
+    {
+        // Part of Algorithm 18: cost 22 flops, error 2.3 u^2
+        DoubleVec<N> th = DoubleVec<N>(1.0) / y._hi;
+        DoubleVec<N> rh =
+            _internal::mul_add_cancel(-y._hi, th, DoubleVec<N>(1.0));
+        DoubleVec<N> rl = -y._lo * th;
+        DDoubleVec e = ExDoubleVec<N>(rh).add_small(rl);
+        DDoubleVec delta = e * th;
+        return delta + th;
+    }
+
+    friend DDoubleVec operator/(DDoubleVec x, DDoubleVec y)
+    {
+        // Algorithm 18: cost 31 flops, error 10 u^2 (6 u^2 obs.)
+        return x * reciprocal(y);
+    }
+
+    friend DDoubleVec operator/(DoubleVec<N> x, DDoubleVec y)
+    {
+        // Algorithm 18: cost 28 flops
+        return x * reciprocal(y);
+    }
+
+    DDoubleVec &operator+=(DDoubleVec y) { return *this = *this + y; }
+    DDoubleVec &operator-=(DDoubleVec y) { return *this = *this - y; }
+    DDoubleVec &operator*=(DDoubleVec y) { return *this = *this * y; }
+    DDoubleVec &operator/=(DDoubleVec y) { return *this = *this / y; }
+
+private:
+    DoubleVec<N> _hi;
+    DoubleVec<N> _lo;
+};
+
+} /* namespace xprec */
+
+#include "internal/simd.h"
@@ -0,0 +1,97 @@
+/* Element-wise kernels for double-double arrays.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/array.h"
+#include "xprec/ddouble.h"
+#include <cassert>
+
+namespace xprec {
+
+XPREC_API_EXPORT
+DDoubleArray::DDoubleArray(const DDouble *x, size_t n) : _hi(n), _lo(n)
+{
+    for (size_t i = 0; i != n; ++i) {
+        _hi[i] = x[i].hi();
+        _lo[i] = x[i].lo();
+    }
+}
+
+XPREC_API_EXPORT
+void DDoubleArray::get(DDouble *x) const
+{
+    for (size_t i = 0; i != size(); ++i)
+        x[i] = DDouble(_hi[i], _lo[i]);
+}
+
+// The loops below are kept free of branches and only ever touch element i
+// of each plane, so after inlining the arithmetic they can be vectorized.
+// The output planes may alias the input planes, which the compiler handles
+// by a runtime check.
+
+template <typename Op>
+static void binary_kernel(const DDoubleArray &x, const DDoubleArray &y,
+                          DDoubleArray &z, Op op)
+{
+    assert(x.size() == y.size());
+    const size_t n = x.size();
+    z.resize(n);
+
+    const double *x_hi = x.hi(), *x_lo = x.lo();
+    const double *y_hi = y.hi(), *y_lo = y.lo();
+    double *z_hi = z.hi(), *z_lo = z.lo();
+    for (size_t i = 0; i < n; ++i) {
+        DDouble r = op(DDouble(x_hi[i], x_lo[i]), DDouble(y_hi[i], y_lo[i]));
+        z_hi[i] = r.hi();
+        z_lo[i] = r.lo();
+    }
+}
+
+template <typename Op>
+static void unary_kernel(const DDoubleArray &x, DDoubleArray &z, Op op)
+{
+    const size_t n = x.size();
+    z.resize(n);
+
+    const double *x_hi = x.hi(), *x_lo = x.lo();
+    double *z_hi = z.hi(), *z_lo = z.lo();
+    for (size_t i = 0; i < n; ++i) {
+        DDouble r = op(DDouble(x_hi[i], x_lo[i]));
+        z_hi[i] = r.hi();
+        z_lo[i] = r.lo();
+    }
+}
+
+XPREC_API_EXPORT
+void add(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z)
+{
+    binary_kernel(x, y, z, [](DDouble a, DDouble b) { return a + b; });
+}
+
+XPREC_API_EXPORT
+void subtract(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z)
+{
+    binary_kernel(x, y, z, [](DDouble a, DDouble b) { return a - b; });
+}
+
+XPREC_API_EXPORT
+void multiply(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z)
+{
+    binary_kernel(x, y, z, [](DDouble a, DDouble b) { return a * b; });
+}
+
+XPREC_API_EXPORT
+void divide(const DDoubleArray &x, const DDoubleArray &y, DDoubleArray &z)
+{
+    binary_kernel(x, y, z, [](DDouble a, DDouble b) { return a / b; });
+}
+
+XPREC_API_EXPORT
+void reciprocal(const DDoubleArray &x, DDoubleArray &z)
+{
+    unary_kernel(x, z, [](DDouble a) { return reciprocal(a); });
+}
+
+} /* namespace xprec */
@@ -0,0 +1,96 @@
+/* Helpers for batched (lane-parallel) mathematical functions.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstddef>
+
+#include "xprec/ddouble.h"
+#include "xprec/simd.h"
+
+// Pack width used by the batched functions
+#define XPREC_BATCH_WIDTH XPREC_SIMD_WIDTH
+
+namespace xprec {
+
+/**
+ * Round lanes to nearest integer, ties to even.
+ *
+ * Adding and subtracting 1.5 * 2^52 pushes all fractional bits out of the
+ * mantissa.  Only valid for abs(x) < 2^51, which is all we ever need for
+ * argument reduction.
+ */
+template <int N>
+inline DoubleVec<N> rint_small(DoubleVec<N> x)
+{
+    const double magic = 6755399441055744.0;
+    return (x + magic) - magic;
+}
+
+/**
+ * Round lanes towards zero.  Only valid for abs(x) < 2^51.
+ */
+template <int N>
+inline DoubleVec<N> trunc_small(DoubleVec<N> x)
+{
+    // If f = rint(a) is above a, then a > 1/2, so the difference f - a is
+    // exact and at least 2^-53.  Scaling it saturates the correction at 1.
+    const double scale = 1152921504606846976.0; // 2^60
+    DoubleVec<N> a = max(x, -x);
+    DoubleVec<N> f = rint_small(a);
+    f = f - min(max((f - a) * scale, 0.0), 1.0);
+
+    // Restore the sign: f is zero unless abs(x) >= 1.
+    return f * min(max(x * scale, -1.0), 1.0);
+}
+
+/**
+ * Select lanes of a where m is 0 and lanes of b where m is 1.
+ *
+ * This is exact as long as a and b are finite, because one of the products
+ * is always zero.
+ */
+template <int N>
+inline DDoubleVec<N> choose(DoubleVec<N> m, DDoubleVec<N> a, DDoubleVec<N> b)
+{
+    DoubleVec<N> notm = 1.0 - m;
+    return DDoubleVec<N>(a.hi() * notm + b.hi() * m,
+                         a.lo() * notm + b.lo() * m);
+}
+
+/**
+ * Apply function to n elements of x and store the result to y.
+ *
+ * Fn must provide a lane-parallel kernel fn(DDoubleVec<N>), the scalar
+ * function fn(DDouble), and a predicate fn.special(DDouble).  The kernel is
+ * applied to full packs of N elements: it must be safe to call for any input,
+ * but need only give correct results for lanes where special() is false.
+ * Those lanes, as well as the remainder, are recomputed with the scalar
+ * function.  y may alias x.
+ */
+template <int N, typename Fn>
+void apply_batch(const DDouble *x, DDouble *y, size_t n, Fn fn)
+{
+    size_t i = 0;
+    for (; i + N <= n; i += N) {
+        // Check for special lanes before the store, which may overwrite x
+        DDoubleVec<N> xv = DDoubleVec<N>::load(x + i);
+        bool any_special = false;
+        for (int k = 0; k != N; ++k)
+            any_special |= fn.special(x[i + k]);
+
+        fn(xv).store(y + i);
+        if (any_special) {
+            for (int k = 0; k != N; ++k) {
+                DDouble xk = xv[k];
+                if (fn.special(xk))
+                    y[i + k] = fn(xk);
+            }
+        }
+    }
+    for (; i < n; ++i)
+        y[i] = fn(x[i]);
+}
+
+} /* namespace xprec */
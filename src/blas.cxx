@@ -0,0 +1,683 @@
+/* Accurate and reproducible reductions, matrix products.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "batch.h"
+#include "export.h"
+#include "parallel.h"
+#include "xprec/blas.h"
+#include "xprec/ddouble.h"
+#include "xprec/simd.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace xprec {
+
+/**
+ * State of the Sum2 algorithm: a running sum s in double precision together
+ * with the accumulated rounding errors c.
+ */
+class Sum2Accumulator {
+public:
+    Sum2Accumulator() : _s(0.0), _c(0.0) { }
+
+    /** Add x to the sum */
+    void add(double x)
+    {
+        DDouble t = ExDouble(_s) + x;
+        _s = t.hi();
+        _c += t.lo();
+    }
+
+    /** Add x to the correction only, which is fine for small terms */
+    void add_correction(double x) { _c += x; }
+
+    /** Add x * y to the sum (Dot2) */
+    void add_product(double x, double y)
+    {
+        DDouble p = ExDouble(x) * y;
+        add(p.hi());
+        _c += p.lo();
+    }
+
+    /** Result as double-double */
+    DDouble result() const
+    {
+        // Sum of infinities yields a NaN correction
+        if (!std::isfinite(_s))
+            return _s;
+        return ExDouble(_s) + _c;
+    }
+
+private:
+    double _s, _c;
+};
+
+// The vector kernels keep two independent Sum2 states per lane, since the
+// dependency chain through two_sum is six flops long.  At the end, the
+// lanes are merged into a scalar Sum2 state, which then also takes care
+// of the remainder.
+
+template <int N>
+static void sum2_merge(Sum2Accumulator &acc, DoubleVec<N> s, DoubleVec<N> c)
+{
+    for (int k = 0; k != N; ++k) {
+        acc.add(s[k]);
+        acc.add_correction(c[k]);
+    }
+}
+
+template <int N>
+static void sum2_step(DoubleVec<N> &s, DoubleVec<N> &c, DoubleVec<N> x)
+{
+    DDoubleVec<N> t = ExDoubleVec<N>(s) + x;
+    s = t.hi();
+    c = c + t.lo();
+}
+
+template <int N>
+static void dot2_step(DoubleVec<N> &s, DoubleVec<N> &c, DoubleVec<N> x,
+                      DoubleVec<N> y)
+{
+    DDoubleVec<N> p = ExDoubleVec<N>(x) * y;
+    DDoubleVec<N> t = ExDoubleVec<N>(s) + p.hi();
+    s = t.hi();
+    c = c + (t.lo() + p.lo());
+}
+
+template <int N>
+static DDouble sum2_kernel(const double *x, size_t n)
+{
+    const DoubleVec<N> zero = 0.0;
+    DoubleVec<N> s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+    size_t i = 0;
+    for (; i + 2 * N <= n; i += 2 * N) {
+        sum2_step(s0, c0, DoubleVec<N>::load(x + i));
+        sum2_step(s1, c1, DoubleVec<N>::load(x + i + N));
+    }
+
+    Sum2Accumulator acc;
+    sum2_merge(acc, s0, c0);
+    sum2_merge(acc, s1, c1);
+    for (; i < n; ++i)
+        acc.add(x[i]);
+    return acc.result();
+}
+
+template <int N>
+static DDouble sum2_kernel(const DDouble *x, size_t n)
+{
+    // The lo parts are below the rounding error of the hi parts, so they
+    // can go straight into the correction.
+    const DoubleVec<N> zero = 0.0;
+    DoubleVec<N> s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+    size_t i = 0;
+    for (; i + 2 * N <= n; i += 2 * N) {
+        DDoubleVec<N> x0 = DDoubleVec<N>::load(x + i);
+        DDoubleVec<N> x1 = DDoubleVec<N>::load(x + i + N);
+        sum2_step(s0, c0, x0.hi());
+        sum2_step(s1, c1, x1.hi());
+        c0 = c0 + x0.lo();
+        c1 = c1 + x1.lo();
+    }
+
+    Sum2Accumulator acc;
+    sum2_merge(acc, s0, c0);
+    sum2_merge(acc, s1, c1);
+    for (; i < n; ++i) {
+        acc.add(x[i].hi());
+        acc.add_correction(x[i].lo());
+    }
+    return acc.result();
+}
+
+template <int N>
+static DDouble dot2_kernel(const double *x, const double *y, size_t n)
+{
+    const DoubleVec<N> zero = 0.0;
+    DoubleVec<N> s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+    size_t i = 0;
+    for (; i + 2 * N <= n; i += 2 * N) {
+        dot2_step(s0, c0, DoubleVec<N>::load(x + i),
+                  DoubleVec<N>::load(y + i));
+        dot2_step(s1, c1, DoubleVec<N>::load(x + i + N),
+                  DoubleVec<N>::load(y + i + N));
+    }
+
+    Sum2Accumulator acc;
+    sum2_merge(acc, s0, c0);
+    sum2_merge(acc, s1, c1);
+    for (; i < n; ++i)
+        acc.add_product(x[i], y[i]);
+    return acc.result();
+}
+
+template <int N>
+static DDouble dot2_kernel(const DDouble *x, const DDouble *y, size_t n)
+{
+    // Only the product of the hi parts needs to be error-free: the cross
+    // terms are of order u and go to the correction, and the product of the
+    // lo parts is negligible.
+    const DoubleVec<N> zero = 0.0;
+    DoubleVec<N> s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+    size_t i = 0;
+    for (; i + 2 * N <= n; i += 2 * N) {
+        DDoubleVec<N> x0 = DDoubleVec<N>::load(x + i);
+        DDoubleVec<N> y0 = DDoubleVec<N>::load(y + i);
+        DDoubleVec<N> x1 = DDoubleVec<N>::load(x + i + N);
+        DDoubleVec<N> y1 = DDoubleVec<N>::load(y + i + N);
+        dot2_step(s0, c0, x0.hi(), y0.hi());
+        dot2_step(s1, c1, x1.hi(), y1.hi());
+        c0 = c0 + (x0.hi() * y0.lo() + x0.lo() * y0.hi());
+        c1 = c1 + (x1.hi() * y1.lo() + x1.lo() * y1.hi());
+    }
+
+    Sum2Accumulator acc;
+    sum2_merge(acc, s0, c0);
+    sum2_merge(acc, s1, c1);
+    for (; i < n; ++i) {
+        acc.add_product(x[i].hi(), y[i].hi());
+        acc.add_correction(x[i].hi() * y[i].lo() + x[i].lo() * y[i].hi());
+    }
+    return acc.result();
+}
+
+XPREC_API_EXPORT
+DDouble sum(const double *x, size_t n)
+{
+    return sum2_kernel<XPREC_BATCH_WIDTH>(x, n);
+}
+
+XPREC_API_EXPORT
+DDouble sum(const DDouble *x, size_t n)
+{
+    return sum2_kernel<XPREC_BATCH_WIDTH>(x, n);
+}
+
+XPREC_API_EXPORT
+DDouble dot(const double *x, const double *y, size_t n)
+{
+    return dot2_kernel<XPREC_BATCH_WIDTH>(x, y, n);
+}
+
+XPREC_API_EXPORT
+DDouble dot(const DDouble *x, const DDouble *y, size_t n)
+{
+    return dot2_kernel<XPREC_BATCH_WIDTH>(x, y, n);
+}
+
+// -------------------------------------------------------------------------
+// Reproducible sums
+
+XPREC_API_EXPORT
+ReproducibleSum::ReproducibleSum(double max_abs, size_t max_n)
+    : _scale(1.0), _carry(0.0), _special(0.0), _count(0)
+{
+    assert(max_abs >= 0 && max_abs <= DBL_MAX);
+
+    // Each level holds a sum of at most _max_n = 2^(guard - 2) slices, each
+    // of which is a multiple of 2^(top - 53) and smaller than 2^(top - guard)
+    // in magnitude.  Every partial sum is thus again a multiple of
+    // 2^(top - 53) smaller than 2^(top - 2), which is exact.  After that many
+    // slices, we renormalize the levels (see reproducible_normalize), so
+    // there is no limit on the total number of terms.
+    int guard = 3;
+    while (guard < 40 && (size_t(1) << (guard - 2)) < max_n)
+        ++guard;
+    _max_n = size_t(1) << (guard - 2);
+
+    // Terms are smaller than 2^top / 2^guard.  If the first boundary would
+    // overflow, we scale down all terms by a power of two instead.
+    int top;
+    std::frexp(max_abs, &top);
+    top += guard;
+    if (top > DBL_MAX_EXP - 1) {
+        _scale = std::ldexp(1.0, DBL_MAX_EXP - 1 - top);
+        top = DBL_MAX_EXP - 1;
+    }
+
+    // The remainder after each level is at most 2^(top - 53) in magnitude.
+    // Boundaries below the subnormal range become zero: then the slice is
+    // the full remainder, which is tiny enough to be summed exactly anyway.
+    for (int k = 0; k != LEVELS; ++k) {
+        _sigma[k] = std::ldexp(1.0, top);
+        _sum[k] = 0.0;
+        top -= 53 - guard;
+    }
+}
+
+/**
+ * Cut r into slices along the boundaries sigma and add them to sum.
+ *
+ * (sigma + r) - sigma rounds r to a multiple of ulp(sigma), which is exact
+ * in floating-point arithmetic, and so is the remainder r - slice.
+ */
+template <typename T>
+static void reproducible_slice(const double *sigma, T *sum, T r, int levels)
+{
+    for (int k = 0; k != levels; ++k) {
+        T slice = (sigma[k] + r) - sigma[k];
+        sum[k] = sum[k] + slice;
+        r = r - slice;
+    }
+}
+
+/**
+ * Move the part of each level sum which is a multiple of unit to the level
+ * above, and from the first level to carry, such that every level is again
+ * small enough to take _max_n slices.
+ *
+ * The remainder s - c of each level is in [-unit/2, unit/2), which only
+ * depends on the exact sum of all slices, not on how many were carried
+ * before.  Normalizing before rounding thus keeps the result reproducible no
+ * matter when each partial accumulator was normalized.
+ */
+static void reproducible_normalize(const double *sigma, double *sum,
+                                   double &carry, int levels)
+{
+    for (int k = levels - 1; k >= 0; --k) {
+        double unit = k != 0 ? std::ldexp(sigma[k - 1], -53) : 0.5 * sigma[0];
+        if (unit == 0)
+            continue;
+        double c = std::floor(sum[k] / unit + 0.5) * unit;
+        sum[k] -= c;
+        if (k != 0)
+            sum[k - 1] += c;
+        else
+            carry += c;
+    }
+}
+
+/**
+ * Slice n terms from x, and n terms from lo unless it is null, and add them
+ * to sum.
+ *
+ * Returns false and leaves sum untouched if any term is not finite.
+ * Because the sums of slices are exact, it does not matter that the lanes
+ * are summed separately before being merged.
+ */
+template <int N, int LEVELS>
+static bool reproducible_kernel(const double *sigma, double *sum,
+                                PowerOfTwo scale, const double *x,
+                                const double *lo, size_t n)
+{
+    // Infinities and NaNs turn check into NaN
+    const DoubleVec<N> zero = 0.0;
+    DoubleVec<N> lane_sum[LEVELS], check = zero;
+    for (int k = 0; k != LEVELS; ++k)
+        lane_sum[k] = zero;
+
+    size_t i = 0;
+    for (; i + N <= n; i += N) {
+        DoubleVec<N> r = DoubleVec<N>::load(x + i) * (double)scale;
+        check = check + r * 0.0;
+        reproducible_slice(sigma, lane_sum, r, LEVELS);
+        if (lo != nullptr) {
+            r = DoubleVec<N>::load(lo + i) * (double)scale;
+            check = check + r * 0.0;
+            reproducible_slice(sigma, lane_sum, r, LEVELS);
+        }
+    }
+
+    double tail_sum[LEVELS] = {}, tail_check = 0.0;
+    for (; i < n; ++i) {
+        double r = x[i] * scale;
+        tail_check += r * 0.0;
+        reproducible_slice(sigma, tail_sum, r, LEVELS);
+        if (lo != nullptr) {
+            r = lo[i] * scale;
+            tail_check += r * 0.0;
+            reproducible_slice(sigma, tail_sum, r, LEVELS);
+        }
+    }
+
+    if (tail_check != 0.0)
+        return false;
+    for (int l = 0; l != N; ++l) {
+        if (check[l] != 0.0)
+            return false;
+    }
+    for (int k = 0; k != LEVELS; ++k) {
+        sum[k] += tail_sum[k];
+        for (int l = 0; l != N; ++l)
+            sum[k] += lane_sum[k][l];
+    }
+    return true;
+}
+
+XPREC_API_EXPORT
+void ReproducibleSum::add(double x)
+{
+    if (!std::isfinite(x)) {
+        _special += x;
+        return;
+    }
+    if (_count == _max_n) {
+        reproducible_normalize(_sigma, _sum, _carry, LEVELS);
+        _count = 0;
+    }
+    ++_count;
+    reproducible_slice(_sigma, _sum, x * _scale, LEVELS);
+}
+
+XPREC_API_EXPORT
+void ReproducibleSum::add(const double *x, size_t n)
+{
+    while (n != 0) {
+        if (_count == _max_n) {
+            reproducible_normalize(_sigma, _sum, _carry, LEVELS);
+            _count = 0;
+        }
+        size_t m = std::min(n, _max_n - _count);
+        if (reproducible_kernel<XPREC_BATCH_WIDTH, LEVELS>(_sigma, _sum,
+                                                           _scale, x, nullptr,
+                                                           m)) {
+            _count += m;
+        } else {
+            for (size_t i = 0; i != m; ++i)
+                add(x[i]);
+        }
+        x += m;
+        n -= m;
+    }
+}
+
+XPREC_API_EXPORT
+void ReproducibleSum::add(const DDouble *x, size_t n)
+{
+    // Deinterleave in blocks, so that we can use the same kernel.  Each
+    // DDouble counts as two slices, and _max_n is even.
+    const size_t block = 256;
+    double hi[block], lo[block];
+    while (n != 0) {
+        if (_count + 2 > _max_n) {
+            reproducible_normalize(_sigma, _sum, _carry, LEVELS);
+            _count = 0;
+        }
+        size_t m = std::min(std::min(block, n), (_max_n - _count) / 2);
+        for (size_t j = 0; j != m; ++j) {
+            hi[j] = x[j].hi();
+            lo[j] = x[j].lo();
+        }
+        if (reproducible_kernel<XPREC_BATCH_WIDTH, LEVELS>(_sigma, _sum,
+                                                           _scale, hi, lo, m)) {
+            _count += 2 * m;
+        } else {
+            for (size_t j = 0; j != m; ++j) {
+                add(hi[j]);
+                add(lo[j]);
+            }
+        }
+        x += m;
+        n -= m;
+    }
+}
+
+XPREC_API_EXPORT
+ReproducibleSum &ReproducibleSum::operator+=(const ReproducibleSum &other)
+{
+    assert(_sigma[0] == other._sigma[0] && _max_n == other._max_n);
+
+    // Normalized levels are tiny compared to their capacity, so adding two
+    // of them is exact.
+    double other_sum[LEVELS], other_carry = other._carry;
+    std::copy(other._sum, other._sum + LEVELS, other_sum);
+    reproducible_normalize(_sigma, other_sum, other_carry, LEVELS);
+    reproducible_normalize(_sigma, _sum, _carry, LEVELS);
+    for (int k = 0; k != LEVELS; ++k)
+        _sum[k] += other_sum[k];
+    _carry += other_carry;
+    _special += other._special;
+    reproducible_normalize(_sigma, _sum, _carry, LEVELS);
+    _count = 0;
+    return *this;
+}
+
+XPREC_API_EXPORT
+DDouble ReproducibleSum::result() const
+{
+    // _special is either zero or the sum of the non-finite terms
+    if (!std::isfinite(_special))
+        return _special;
+
+    // The normalized level sums are exact and reproducible, so this is
+    // deterministic
+    double sum[LEVELS], carry = _carry;
+    std::copy(_sum, _sum + LEVELS, sum);
+    reproducible_normalize(_sigma, sum, carry, LEVELS);
+    DDouble r = carry;
+    for (int k = 0; k != LEVELS; ++k)
+        r += sum[k];
+    return r / _scale;
+}
+
+static double max_abs_finite(const double *x, size_t n, size_t stride)
+{
+    double m = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double a = std::fabs(x[i * stride]);
+        if (a > m && a <= DBL_MAX)
+            m = a;
+    }
+    return m;
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_sum(const double *x, size_t n)
+{
+    ReproducibleSum acc(max_abs_finite(x, n, 1), n);
+    acc.add(x, n);
+    return acc.result();
+}
+
+XPREC_API_EXPORT
+DDouble reproducible_sum(const DDouble *x, size_t n)
+{
+    // The lo parts are smaller than the hi parts, so we can skip them
+    const double *hi = reinterpret_cast<const double *>(x);
+    ReproducibleSum acc(max_abs_finite(hi, n, 2), 2 * n);
+    acc.add(x, n);
+    return acc.result();
+}
+
+// -------------------------------------------------------------------------
+// Matrix products
+
+// The micro-kernel keeps an MR x NR block of C in registers, where MR is one
+// pack.  Each task computes one MC x NC tile of C, for which A and B are
+// packed in panels of KC columns and rows, respectively.  Since double-double
+// products are compute-bound, these panels need not be particularly large.
+static const int GEMM_MR = XPREC_BATCH_WIDTH;
+static const int GEMM_NR = 4;
+static const size_t GEMM_MC = 64;
+static const size_t GEMM_NC = 64;
+static const size_t GEMM_KC = 128;
+
+// Products below this number of multiply-adds run on a single thread
+static const double PARALLEL_MIN_WORK = 1 << 18;
+
+/**
+ * Pack mc x kc block of A into slivers of MR rows.
+ *
+ * For each column p, a sliver holds the MR hi parts followed by the MR lo
+ * parts, such that they can be loaded directly into a DDoubleVec.  The last
+ * sliver is padded with zeros.
+ */
+static void gemm_pack_a(size_t mc, size_t kc, const DDouble *a, size_t lda,
+                        double *buf)
+{
+    for (size_t i0 = 0; i0 < mc; i0 += GEMM_MR) {
+        for (size_t p = 0; p != kc; ++p) {
+            for (int i = 0; i != GEMM_MR; ++i) {
+                DDouble v = i0 + i < mc ? a[i0 + i + p * lda] : DDouble(0.0);
+                buf[i] = v.hi();
+                buf[GEMM_MR + i] = v.lo();
+            }
+            buf += 2 * GEMM_MR;
+        }
+    }
+}
+
+/** Pack kc x nc block of B into row-major slivers of NR columns */
+static void gemm_pack_b(size_t kc, size_t nc, const DDouble *b, size_t ldb,
+                        DDouble *buf)
+{
+    for (size_t j0 = 0; j0 < nc; j0 += GEMM_NR) {
+        for (size_t p = 0; p != kc; ++p) {
+            for (int j = 0; j != GEMM_NR; ++j)
+                buf[j] = j0 + j < nc ? b[p + (j0 + j) * ldb] : DDouble(0.0);
+            buf += GEMM_NR;
+        }
+    }
+}
+
+/**
+ * Add alpha times product of packed slivers of A and B to the mr x nr
+ * block of C.
+ */
+template <int N>
+static void gemm_micro(size_t kc, const double *a, const DDouble *b,
+                       DDouble alpha, DDouble *c, size_t ldc, size_t mr,
+                       size_t nr)
+{
+    DDoubleVec<N> acc[GEMM_NR];
+    for (int j = 0; j != GEMM_NR; ++j)
+        acc[j] = DDoubleVec<N>(DDouble(0.0));
+
+    for (size_t p = 0; p != kc; ++p) {
+        DDoubleVec<N> ap = DDoubleVec<N>::load(a, a + N);
+        for (int j = 0; j != GEMM_NR; ++j)
+            acc[j] += ap * DDoubleVec<N>(b[j]);
+        a += 2 * N;
+        b += GEMM_NR;
+    }
+
+    DDouble tmp[N];
+    for (size_t j = 0; j != nr; ++j) {
+        (acc[j] * DDoubleVec<N>(alpha)).store(tmp);
+        for (size_t i = 0; i != mr; ++i)
+            c[i + j * ldc] += tmp[i];
+    }
+}
+
+/** Scale m x n matrix C by beta, where zero overwrites C */
+static void scale_matrix(size_t m, size_t n, DDouble beta, DDouble *c,
+                         size_t ldc)
+{
+    if (beta == 1.0)
+        return;
+    for (size_t j = 0; j != n; ++j) {
+        for (size_t i = 0; i != m; ++i)
+            c[i + j * ldc] = beta == 0.0 ? DDouble(0.0) : beta * c[i + j * ldc];
+    }
+}
+
+/** Compute one tile of C (see gemm), runs on worker threads */
+static void gemm_tile(size_t m, size_t n, size_t k, DDouble alpha,
+                      const DDouble *a, size_t lda, const DDouble *b,
+                      size_t ldb, DDouble beta, DDouble *c, size_t ldc)
+{
+    scale_matrix(m, n, beta, c, ldc);
+    if (alpha == 0.0 || k == 0)
+        return;
+
+    const size_t m_pad = (m + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+    const size_t n_pad = (n + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+    const size_t kc_max = std::min(k, GEMM_KC);
+    std::vector<double> a_pack(2 * m_pad * kc_max);
+    std::vector<DDouble> b_pack(n_pad * kc_max);
+
+    for (size_t p0 = 0; p0 < k; p0 += GEMM_KC) {
+        const size_t kc = std::min(GEMM_KC, k - p0);
+        gemm_pack_a(m, kc, a + p0 * lda, lda, a_pack.data());
+        gemm_pack_b(kc, n, b + p0, ldb, b_pack.data());
+
+        for (size_t j0 = 0; j0 < n; j0 += GEMM_NR) {
+            for (size_t i0 = 0; i0 < m; i0 += GEMM_MR) {
+                gemm_micro<GEMM_MR>(kc, &a_pack[2 * i0 * kc], &b_pack[j0 * kc],
+                                    alpha, c + i0 + j0 * ldc, ldc,
+                                    std::min<size_t>(GEMM_MR, m - i0),
+                                    std::min<size_t>(GEMM_NR, n - j0));
+            }
+        }
+    }
+}
+
+XPREC_API_EXPORT
+void gemm(size_t m, size_t n, size_t k, DDouble alpha, const DDouble *a,
+          size_t lda, const DDouble *b, size_t ldb, DDouble beta, DDouble *c,
+          size_t ldc)
+{
+    assert(lda >= std::max<size_t>(m, 1));
+    assert(ldb >= std::max<size_t>(k, 1));
+    assert(ldc >= std::max<size_t>(m, 1));
+
+    const size_t m_tiles = (m + GEMM_MC - 1) / GEMM_MC;
+    const size_t n_tiles = (n + GEMM_NC - 1) / GEMM_NC;
+    double work = (double)m * n * k;
+    unsigned nthreads = work < PARALLEL_MIN_WORK ? 1 : max_threads();
+
+    parallel_for(m_tiles * n_tiles, nthreads, [&](size_t t) {
+        size_t i0 = (t % m_tiles) * GEMM_MC;
+        size_t j0 = (t / m_tiles) * GEMM_NC;
+        gemm_tile(std::min(GEMM_MC, m - i0), std::min(GEMM_NC, n - j0), k,
+                  alpha, a + i0, lda, b + j0 * ldb, ldb, beta,
+                  c + i0 + j0 * ldc, ldc);
+    });
+}
+
+// Number of rows of y computed by one task in gemv
+static const size_t GEMV_ROWS = 256;
+
+/** Compute m consecutive elements of y (see gemv), runs on worker threads */
+static void gemv_rows(size_t m, size_t n, DDouble alpha, const DDouble *a,
+                      size_t lda, const DDouble *x, DDouble beta, DDouble *y)
+{
+    // Two independent accumulators hide the latency of the additions
+    const int N = XPREC_BATCH_WIDTH;
+    DDouble tmp[2 * N];
+    size_t i = 0;
+    for (; i + 2 * N <= m; i += 2 * N) {
+        DDoubleVec<N> acc0 = DDouble(0.0), acc1 = DDouble(0.0);
+        for (size_t j = 0; j != n; ++j) {
+            DDoubleVec<N> xj = x[j];
+            acc0 += DDoubleVec<N>::load(a + i + j * lda) * xj;
+            acc1 += DDoubleVec<N>::load(a + i + N + j * lda) * xj;
+        }
+        acc0.store(tmp);
+        acc1.store(tmp + N);
+        for (int l = 0; l != 2 * N; ++l) {
+            y[i + l] = beta == 0.0 ? alpha * tmp[l]
+                                   : alpha * tmp[l] + beta * y[i + l];
+        }
+    }
+    for (; i < m; ++i) {
+        DDouble acc = 0.0;
+        for (size_t j = 0; j != n; ++j)
+            acc += a[i + j * lda] * x[j];
+        y[i] = beta == 0.0 ? alpha * acc : alpha * acc + beta * y[i];
+    }
+}
+
+XPREC_API_EXPORT
+void gemv(size_t m, size_t n, DDouble alpha, const DDouble *a, size_t lda,
+          const DDouble *x, DDouble beta, DDouble *y)
+{
+    assert(lda >= std::max<size_t>(m, 1));
+
+    const size_t tasks = (m + GEMV_ROWS - 1) / GEMV_ROWS;
+    double work = (double)m * n;
+    unsigned nthreads = work < PARALLEL_MIN_WORK ? 1 : max_threads();
+
+    parallel_for(tasks, nthreads, [&](size_t t) {
+        size_t i0 = t * GEMV_ROWS;
+        gemv_rows(std::min(GEMV_ROWS, m - i0), n, alpha, a + i0, lda, x, beta,
+                  y + i0);
+    });
+}
+
+} /* namespace xprec */
@@ -3,13 +3,12 @@
  * Copyright (C) 2023 Markus Wallerberger and others
  * SPDX-License-Identifier: MIT
  */
+#include "batch.h"
+#include "export.h"
 #include "taylor.h"
 #include "xprec/ddouble.h"
 #include "xprec/numbers.h"
-
-#ifndef XPREC_API_EXPORT
-#define XPREC_API_EXPORT
-#endif
+#include "xprec/simd.h"
 
 namespace xprec {
 
@@ -20,7 +19,7 @@ DDouble trig_complement(DDouble x)
         return sqrt(1.0 - x * x);
 
     // Search for a zero of f(y) = y^2 + x^2 - 1
-    ExDouble y0 = std::sqrt(std::fma(x.hi(), -x.hi(), 1));
+    ExDouble y0 = std::sqrt(_internal::mul_add(x.hi(), -x.hi(), 1));
 
     // Newton-Ralphson iteration
     //      y = y - f(y) / f'(y) = y - (y^2 + x^2 - 1) / 2 y
@@ -29,133 +28,356 @@ DDouble trig_complement(DDouble x)
     return y;
 }
 
-static DDouble sin_kernel(DDouble x, int n = 13)
+/**
+ * Sine and cos(x) - 1 for abs(x) <= 1/128, sharing the square of x.
+ *
+ * Only the two leading terms after the first need double-double arithmetic,
+ * the remaining ones are below 1e-16 of the result.
+ */
+static void sincos_taylor(DDouble x, DDouble &s, DDouble &cm1)
 {
-    // We need this to go out to pi/4 ~= 0.785
-    // Convergence of the Taylor approx to 2e-32
-    assert(n >= 0 && n <= 13);
-
-    // Taylor series of the sin around 0
     DDouble xsq = -x * x;
-    DDouble r = x;
-    DDouble xpow = x;
-    int i = 3;
-    for (; i <= n + 2; i += 2) {
-        xpow *= xsq;
-        r = r.add_small(reciprocal_factorial(i) * xpow);
-    }
-
-    // Here the terms are so small that they only affect the lo part, so
-    // we can get away with double arithmetic.
     double xsq_d = xsq.hi();
-    double xpow_d = xpow.hi();
-    double r_d = 0;
-    for (; i <= 2 * n + 1; i += 2) {
-        xpow_d *= xsq_d;
-        r_d += reciprocal_factorial(i).hi() * xpow_d;
+
+    // sin(x) = x (1 - x^2/3! + x^4/5! - ...)
+    double ps_d = reciprocal_factorial(7).hi() +
+                  xsq_d * (reciprocal_factorial(9).hi() +
+                           xsq_d * reciprocal_factorial(11).hi());
+    DDouble ps = reciprocal_factorial(3) +
+                 xsq * (reciprocal_factorial(5) + xsq_d * ps_d);
+    s = x.add_small(x * (xsq * ps));
+
+    // cos(x) - 1 = -x^2/2! + x^4/4! - ..., which is accurate relative to
+    // x^2/2 rather than to one.
+    double pc_d = reciprocal_factorial(8).hi() +
+                  xsq_d * reciprocal_factorial(10).hi();
+    DDouble pc = reciprocal_factorial(4) +
+                 xsq * (reciprocal_factorial(6) + xsq_d * pc_d);
+    cm1 = (PowerOfTwo(0.5) * xsq).add_small(xsq * (xsq * pc));
+}
+
+// sin(k/64) and cos(k/64) for k = 0, ..., 50, which covers [0, pi/4]
+static const DDouble SIN_64TH[51] = {
+    {0.0, 0.0},
+    {0.015624364224883372, -1.2650937552759816e-19},
+    {0.03124491398532608, -1.562781562225433e-18},
+    {0.04685783574813424, -2.3419368365610254e-18},
+    {0.0624593178423802, -2.040259504585711e-18},
+    {0.07804555138996731, -5.449443782005793e-18},
+    {0.09361273123551289, 1.4628632005878733e-18},
+    {0.10915705687532236, 6.6284699502736666e-18},
+    {0.12467473338522769, -2.925947496057858e-18},
+    {0.1401619723470637, -9.946847113883478e-18},
+    {0.15561499277355603, 8.886053372342288e-18},
+    {0.17103002203139503, -9.954774726452923e-18},
+    {0.18640329676226988, 2.3493796901281573e-18},
+    {0.2017310638016388, 5.587232815460113e-18},
+    {0.21700958109501015, 1.1170071073364376e-17},
+    {0.23223511861151147, -8.318080852687206e-18},
+    {0.24740395925452294, -7.53102495590706e-18},
+    {0.2625123997691533, -2.2534597527902125e-17},
+    {0.2775567516463363, 1.7674070262791822e-17},
+    {0.29253334202332754, 7.516944930327352e-18},
+    {0.30743851458038085, 1.1004366442765296e-19},
+    {0.3222686304333866, 2.093773358126606e-17},
+    {0.33702006902225307, 1.0312279860787216e-17},
+    {0.3516892289948141, -2.5616208736069942e-17},
+    {0.36627252908604757, -9.938814562106524e-18},
+    {0.38076640899239017, 2.1372528646211374e-17},
+    {0.39516733024093426, -1.9613487871414228e-17},
+    {0.40947177705329507, -5.679403000091266e-18},
+    {0.42367625720393803, -2.331800700068871e-17},
+    {0.4377773028727551, 7.64345629962023e-18},
+    {0.4517714714916838, -8.234073942098903e-18},
+    {0.46565534658516017, 1.459870391051426e-17},
+    {0.479425538604203, -5.103969860556013e-18},
+    {0.49307868575392305, 5.605083973871755e-18},
+    {0.5066114548142574, -3.269413423618168e-17},
+    {0.520020541953727, -3.983266745698455e-17},
+    {0.5333026735360201, 5.129318115032044e-17},
+    {0.5464546069192036, 8.399754840929507e-18},
+    {0.5594731312473669, 1.575565514488728e-17},
+    {0.5723550682345072, 2.6575872357215316e-17},
+    {0.5850972729404622, -5.4883972461161805e-17},
+    {0.5976966345387015, 5.450323593054385e-17},
+    {0.6101500770757914, -1.479826990758988e-17},
+    {0.6224545602223437, -6.049035765709707e-18},
+    {0.6346070800152693, -3.4568582392624965e-17},
+    {0.6466046695911524, 4.567647714393289e-19},
+    {0.6584443999105676, -3.7736386700306717e-17},
+    {0.6701233804731629, 6.183536725574959e-18},
+    {0.6816387600233341, 4.410467313197903e-17},
+    {0.692987727246318, -5.3543290798909455e-17},
+    {0.7041675114545337, -3.94095700584825e-17}};
+static const DDouble COS_64TH[51] = {
+    {1.0, 0.0},
+    {0.9998779321710066, 3.216122229972341e-17},
+    {0.9995117584851364, -3.418806487972947e-17},
+    {0.9989015683384429, -2.1425557800399754e-17},
+    {0.9980475107000991, 3.3232291674141346e-17},
+    {0.9969497940760287, -1.2467075728553626e-17},
+    {0.9956086864580017, 3.312922430932991e-17},
+    {0.9940245152582091, 1.3287985046260087e-17},
+    {0.992197667229329, 4.754870575189364e-17},
+    {0.9901285883701071, -4.589906353553811e-18},
+    {0.9878177838164719, 4.91917302237681e-17},
+    {0.9852658177182139, -4.925721262944555e-17},
+    {0.9824733131012553, -3.919920375420088e-17},
+    {0.9794409517155483, 1.3108769521526758e-17},
+    {0.9761694738686353, -7.850690609285027e-18},
+    {0.9726596782449127, 2.3920264546490165e-17},
+    {0.9689124217106447, 5.071436662403936e-17},
+    {0.964928619104771, -3.0345542681018625e-18},
+    {0.9607092430155619, -2.807827063516729e-17},
+    {0.9562553235431753, -3.148450868841629e-17},
+    {0.9515679480481722, -3.8614834675674123e-17},
+    {0.9466482608860534, -3.911683334934152e-17},
+    {0.9414974631278811, -4.8523830236797095e-18},
+    {0.9361168122670553, -5.2350302039683216e-17},
+    {0.9305076219123143, 4.488760003328074e-18},
+    {0.924671261467036, 5.5444125388034563e-17},
+    {0.9186091557949183, -4.0564150104514996e-17},
+    {0.9123227848721178, 2.6349040211413332e-17},
+    {0.9058136834259364, 4.2864666490805214e-17},
+    {0.8990834405601384, 9.076951775075616e-18},
+    {0.8921336993669944, 2.3160655211380166e-17},
+    {0.8849661565261433, -7.690557775987357e-18},
+    {0.8775825618903728, -4.2623149864279997e-17},
+    {0.8699847180584174, 1.657385110740923e-17},
+    {0.8621744799348805, 4.4132427578105805e-18},
+    {0.8541537542773854, 5.420565102675286e-18},
+    {0.8459244992310679, 1.549506647350329e-17},
+    {0.8374887238505236, 4.3337026043948396e-17},
+    {0.8288484876093257, 1.1163935406617444e-17},
+    {0.820005899897234, -3.912431748209128e-17},
+    {0.8109631195052179, -3.091333486122179e-17},
+    {0.8017223540984184, 4.0134533311087014e-17},
+    {0.7922858596771786, -2.9049779312834576e-17},
+    {0.7826559400262728, -1.474071641211487e-17},
+    {0.7728349461524715, 4.231014921891023e-17},
+    {0.7628252757105762, 1.6672995021546628e-17},
+    {0.7526293724180665, -1.2970993013150526e-17},
+    {0.7422497254585013, -1.2339303604869521e-17},
+    {0.7316888688738209, -1.0475824306512768e-17},
+    {0.7209493809456964, 3.494986701478816e-17},
+    {0.7100338835660797, 1.505272211891291e-17}};
+
+/**
+ * Sine and cosine of x in [-pi/4, pi/4].
+ *
+ * Splits off a = k/64 closest to x, such that r = x - a is exact and
+ * abs(r) <= 1/128, and uses the addition theorems
+ *
+ *   sin(x) = sin(a) + [cos(a) sin(r) + sin(a) (cos(r) - 1)],
+ *   cos(x) = cos(a) + [cos(a) (cos(r) - 1) - sin(a) sin(r)],
+ *
+ * where the table values carry most of the result, so the error of the
+ * short Taylor series only enters the corrections.
+ */
+static void sincos_kernel(DDouble x, DDouble &s, DDouble &c)
+{
+    using xprec::numbers::pi_4;
+    if (!isfinite(x)) {
+        s = c = NAN;
+        return;
     }
-    r = r.add_small(r_d);
-    return r;
+    assert(fabs(x.hi()) <= nextafter(pi_4.hi(), 1));
+
+    double k = std::round(64.0 * x.hi());
+    DDouble r = x - k / 64.0;
+    DDouble sin_r, cosm1_r;
+    sincos_taylor(r, sin_r, cosm1_r);
+
+    int i = (int)std::fabs(k);
+    DDouble sin_a = k < 0 ? -SIN_64TH[i] : SIN_64TH[i];
+    DDouble cos_a = COS_64TH[i];
+    s = sin_a + (cos_a * sin_r + sin_a * cosm1_r);
+    c = cos_a + (cos_a * cosm1_r - sin_a * sin_r);
 }
 
-static DDouble cos_kernel(DDouble x, int n = 13)
+// pi/2 split into four parts.  For integer n < 2^53, the products of n with
+// the first three are exact only as double-double results of two_prod, i.e.,
+// ExDouble(n) * PI_HALF_i, and not as plain double products.  The sum of all
+// four gives n pi/2 to about 2^-210 relative.
+static const double PI_HALF_1 = 1.5707963267948966;
+static const double PI_HALF_2 = 6.123233995736766e-17;
+static const double PI_HALF_3 = -1.4973849048591698e-33;
+static const double PI_HALF_4 = 5.562271104316826e-50;
+
+/** Reciprocal of pi/2 */
+static const DDouble TWO_OVER_PI(0.6366197723675814, -3.935735335036497e-17);
+
+/**
+ * Bits of 2/pi = sum_j b[j] 2^-j, where word i holds b[32i + 1] (most
+ * significant) to b[32i + 32].  This covers the exponent range of double.
+ */
+static const uint32_t TWO_OVER_PI_BITS[40] = {
+    0xa2f9836e, 0x4e441529, 0xfc2757d1, 0xf534ddc0, 0xdb629599, 0x3c439041,
+    0xfe5163ab, 0xdebbc561, 0xb7246e3a, 0x424dd2e0, 0x06492eea, 0x09d1921c,
+    0xfe1deb1c, 0xb129a73e, 0xe88235f5, 0x2ebb4484, 0xe99c7026, 0xb45f7e41,
+    0x3991d639, 0x835339f4, 0x9c845f8b, 0xbdf9283b, 0x1ff897ff, 0xde05980f,
+    0xef2f118b, 0x5a0a6d1f, 0x6d367ecf, 0x27cb09b7, 0x4f463f66, 0x9e5fea2d,
+    0x7527bac7, 0xebe5f17b, 0x3d0739f7, 0x8a5292ea, 0x6bfb5fb1, 0x1f8d5d08,
+    0x56033046, 0xfc7b6bab, 0xf0cfbc20, 0x9af4361d};
+
+/** Sum of b[j] 2^(e - j) for j = j0, ..., j1 as double, where j1 - j0 < 53 */
+static double two_over_pi_bits(int j0, int j1, int e)
 {
-    // We need this to go out to pi/4 ~= 0.785
-    // Convergence of the Taylor approx to 2e-32
-    assert(n >= 0 && n <= 13);
+    assert(j1 - j0 < 53 && j1 <= 32 * 38);
+    if (j0 < 1)
+        j0 = 1;
+    if (j1 < j0)
+        return 0.0;
 
-    // Taylor series of the cos around 0
-    DDouble xsq = -x * x;
-    DDouble xpow = xsq;
-    DDouble r = ExDouble(1.0).add_small(PowerOfTwo(0.5) * xpow);
-    int i = 4;
-    for (; i <= n + 3; i += 2) {
-        xpow *= xsq;
-        r = r.add_small(reciprocal_factorial(i) * xpow);
-    }
+    // Gather 64 bits starting with b[j0] from three consecutive words
+    int word = (j0 - 1) / 32, offset = (j0 - 1) % 32;
+    uint64_t bits = (uint64_t)TWO_OVER_PI_BITS[word] << 32 |
+                    TWO_OVER_PI_BITS[word + 1];
+    uint64_t next = TWO_OVER_PI_BITS[word + 2];
+    bits = bits << offset | next >> (32 - offset);
+    bits >>= 63 - (j1 - j0);
+    return std::ldexp((double)bits, e - j1);
+}
 
-    // Here the terms are so small that they only affect the lo part, so
-    // we can get away with double arithmetic.
-    double xsq_d = xsq.hi();
-    double xpow_d = xpow.hi();
-    double r_d = 0;
-    for (; i <= 2 * n; i += 2) {
-        xpow_d *= xsq_d;
-        r_d += reciprocal_factorial(i).hi() * xpow_d;
+/** Remainder of x modulo four, which is exact */
+static double mod4(double x) { return x - 4.0 * std::floor(0.25 * x); }
+
+/**
+ * Split x 2/pi = n + f for finite x, where n is an integer and abs(f) <= 1/2
+ * is accurate to about 2^-106 absolute, following Payne and Hanek.
+ *
+ * Writing x = M 2^E with integer M < 2^53, the bits b[j] with j < E - 1 only
+ * add multiples of four to n, which do not affect the sector.  We therefore
+ * multiply M exactly with four windows of the following bits, scaled by 2^E
+ * so that they do not underflow, and reduce the products modulo four.
+ * Returns n modulo four.
+ */
+static double payne_hanek(double x, DDouble &f)
+{
+    if (x == 0) {
+        f = 0.0;
+        return 0.0;
     }
-    r = r.add_small(r_d);
-    return r;
+    int E;
+    std::frexp(x, &E);
+    E -= 53;
+    double M = std::ldexp(x, -E);
+
+    // The first window has 52 bits, such that M times it is a multiple of
+    // 2^-50 below 2^55 and the sum of its parts modulo four is exact.
+    DDouble a = ExDouble(M) * two_over_pi_bits(E - 1, E + 50, E);
+    DDouble b = ExDouble(M) * two_over_pi_bits(E + 51, E + 103, E);
+    DDouble c = ExDouble(M) * two_over_pi_bits(E + 104, E + 156, E);
+    double d = M * two_over_pi_bits(E + 157, E + 209, E);
+
+    DDouble s = ExDouble(mod4(a.hi()) + mod4(a.lo())) + b.hi();
+    double n = std::round(s.hi());
+    f = ExDouble(s.hi() - n) + s.lo();
+    f = ((f + b.lo()) + c) + d;
+    return mod4(n);
 }
 
-static DDouble remainder_pi2(DDouble x, int &sector)
+/** Same as remainder_pi2() for abs(x) >= 1e15, infinity and NaN */
+static DDouble remainder_pi2_huge(DDouble x, int &sector)
 {
-    // This reduction has to be done quite carefully, because of the
-    // remainder.
-    using xprec::numbers::pi_half;
-    DDouble n = x / pi_half;
-    if (std::fabs(n.hi()) < 0.5) {
+    if (!isfinite(x)) {
         sector = 0;
-        return x;
+        return NAN;
     }
 
-    // This is a problem for very large revolution count, but there we
-    // have a problem anyway.
-    n = round(n);
-    int64_t n_int = n.as<int64_t>();
-    sector = n_int % 4;
-    if (sector < 0)
-        sector += 4;
-    return x - pi_half * n;
+    // Reduce both parts, since the lo part may be large as well
+    DDouble f_hi, f_lo;
+    double n = payne_hanek(x.hi(), f_hi) + payne_hanek(x.lo(), f_lo);
+    DDouble f = f_hi + f_lo;
+    double m = std::round(f.hi());
+    sector = (int)mod4(n + m);
+    return (f - m) * numbers::pi_half;
 }
 
-static DDouble sin_sector(DDouble x, int sector)
+/**
+ * Reduce x = n pi/2 + r with abs(r) <= pi/4 and return r, where sector is n
+ * modulo four.
+ *
+ * For abs(x) < 1e15, we get n from x 2/pi and subtract n pi/2 in four parts
+ * (Cody and Waite), where the first three products are exact.  Larger
+ * arguments go through the bit table of 2/pi (see payne_hanek()).  In both
+ * cases, r is accurate to about 2^-106 absolute instead of relative to x.
+ */
+static DDouble remainder_pi2(DDouble x, int &sector)
+{
+    if (!(std::fabs(x.hi()) < 1e15))
+        return remainder_pi2_huge(x, sector);
+
+    // Round n from the full product, since its hi part may be off by one ulp
+    DDouble q = x * TWO_OVER_PI;
+    double n = std::round(q.hi());
+    n += std::round((q.hi() - n) + q.lo());
+    sector = (int)mod4(n);
+
+    DDouble p1 = ExDouble(n) * PI_HALF_1;
+    DDouble r = (ExDouble(x.hi()) - p1.hi()) - p1.lo();
+    r = (r + x.lo()) - ExDouble(n) * PI_HALF_2;
+    r = r - ExDouble(n) * PI_HALF_3;
+    return r.add_small(-n * PI_HALF_4);
+}
+
+/**
+ * Given s = sin(x) and c = cos(x), replace them with sin(x + sector pi/2)
+ * and cos(x + sector pi/2).
+ */
+static void sincos_sector(int sector, DDouble &s, DDouble &c)
 {
-    using xprec::numbers::pi_4;
     assert(sector >= 0 && sector < 4);
-    assert(fabs(x.hi()) <= nextafter(pi_4.hi(), 1));
 
+    DDouble sk = s, ck = c;
     switch (sector) {
     case 0:
-        return sin_kernel(x);
+        break;
     case 1:
-        // use sin(x) = cos(x - pi/2)
-        return cos_kernel(x);
+        s = ck;
+        c = -sk;
+        break;
     case 2:
-        // use sin(x) = -sin(x - pi)
-        return -sin_kernel(x);
+        s = -sk;
+        c = -ck;
+        break;
     default:
-        return -cos_kernel(x);
+        s = -ck;
+        c = sk;
     }
 }
 
 XPREC_API_EXPORT
 DDouble sin(DDouble x)
 {
-    int sector;
-    x = remainder_pi2(x, sector);
-    return sin_sector(x, sector);
+    DDouble s, c;
+    sincos(x, s, c);
+    return s;
 }
 
 XPREC_API_EXPORT
 DDouble cos(DDouble x)
 {
-    // For small values, we shall use the cosine directly
-    using xprec::numbers::pi_4;
-    if (std::fabs(x.hi()) < pi_4.hi())
-        return cos_kernel(x);
-
-    // Otherwise, use common code.
-    int sector;
-    x = remainder_pi2(x, sector);
-    return sin_sector(x, (sector + 1) % 4);
+    DDouble s, c;
+    sincos(x, s, c);
+    return c;
 }
 
 XPREC_API_EXPORT
 void sincos(DDouble x, DDouble &s, DDouble &c)
 {
-    // XXX This should be improved
-    s = sin(x);
-    c = cos(x);
+    // Share the argument reduction and both kernels, then assign them to
+    // sine and cosine based on the sector.  Small values need no reduction.
+    using xprec::numbers::pi_4;
+    if (std::fabs(x.hi()) < pi_4.hi()) {
+        sincos_kernel(x, s, c);
+        return;
+    }
+
+    int sector;
+    x = remainder_pi2(x, sector);
+    sincos_kernel(x, s, c);
+    sincos_sector(sector, s, c);
 }
 
 XPREC_API_EXPORT
@@ -263,4 +485,192 @@ DDouble atan2(DDouble y, DDouble x)
     return res;
 }
 
+// ---------------------------------------------------------------------------
+// Batched versions
+//
+// The kernels below use the full Taylor series out to pi/4 rather than the
+// table of the scalar code, since a table lookup would need a gather for
+// every lane.  They compute both the sine and the cosine kernel for every
+// lane, and then select the right one for each lane's sector by exact
+// arithmetic blends.
+
+template <int N>
+static DDoubleVec<N> sin_kernel(DDoubleVec<N> x, int n = 13)
+{
+    DDoubleVec<N> xsq = -x * x;
+    DDoubleVec<N> r = x;
+    DDoubleVec<N> xpow = x;
+    int i = 3;
+    for (; i <= n + 2; i += 2) {
+        xpow *= xsq;
+        r = r.add_small(DDoubleVec<N>(reciprocal_factorial(i)) * xpow);
+    }
+
+    DoubleVec<N> xsq_d = xsq.hi();
+    DoubleVec<N> xpow_d = xpow.hi();
+    DoubleVec<N> r_d = 0.0;
+    for (; i <= 2 * n + 1; i += 2) {
+        xpow_d = xpow_d * xsq_d;
+        r_d = r_d + reciprocal_factorial(i).hi() * xpow_d;
+    }
+    return r.add_small(r_d);
+}
+
+template <int N>
+static DDoubleVec<N> cos_kernel(DDoubleVec<N> x, int n = 13)
+{
+    DDoubleVec<N> xsq = -x * x;
+    DDoubleVec<N> xpow = xsq;
+    DDoubleVec<N> r = ExDoubleVec<N>(1.0).add_small(PowerOfTwo(0.5) * xpow);
+    int i = 4;
+    for (; i <= n + 3; i += 2) {
+        xpow *= xsq;
+        r = r.add_small(DDoubleVec<N>(reciprocal_factorial(i)) * xpow);
+    }
+
+    DoubleVec<N> xsq_d = xsq.hi();
+    DoubleVec<N> xpow_d = xpow.hi();
+    DoubleVec<N> r_d = 0.0;
+    for (; i <= 2 * n; i += 2) {
+        xpow_d = xpow_d * xsq_d;
+        r_d = r_d + reciprocal_factorial(i).hi() * xpow_d;
+    }
+    return r.add_small(r_d);
+}
+
+template <int N>
+static DoubleVec<N> mod4(DoubleVec<N> k)
+{
+    // k/4 has a fractional part of 0, 1/4, 1/2 or 3/4, so shifting it by
+    // 3/8 and rounding to nearest gives floor(k/4).
+    return k - 4.0 * rint_small(0.25 * k - 0.375);
+}
+
+template <int N>
+static DDoubleVec<N> remainder_pi2(DDoubleVec<N> x, DoubleVec<N> &sector)
+{
+    // Same as the scalar version.  Valid for abs(x) < 1e15, where the
+    // quotient fits into the rounding trick, larger arguments are special.
+    DDoubleVec<N> q = x * DDoubleVec<N>(TWO_OVER_PI);
+    DoubleVec<N> k = rint_small(q.hi());
+    k = k + rint_small((q.hi() - k) + q.lo());
+    sector = mod4(k);
+
+    DDoubleVec<N> p1 = ExDoubleVec<N>(k) * DoubleVec<N>(PI_HALF_1);
+    DDoubleVec<N> r = (ExDoubleVec<N>(x.hi()) - p1.hi()) - p1.lo();
+    r = (r + x.lo()) - ExDoubleVec<N>(k) * DoubleVec<N>(PI_HALF_2);
+    r = r - ExDoubleVec<N>(k) * DoubleVec<N>(PI_HALF_3);
+    return r.add_small(-k * DoubleVec<N>(PI_HALF_4));
+}
+
+template <int N>
+static DDoubleVec<N> sin_sector(DoubleVec<N> sector, DDoubleVec<N> sk,
+                                DDoubleVec<N> ck)
+{
+    // Sectors 1 and 3 use the cosine kernel, sectors 2 and 3 flip the sign,
+    // which is the same as the switch in the scalar sin_sector().
+    DoubleVec<N> upper = rint_small(0.5 * sector - 0.25);
+    DoubleVec<N> odd = sector - 2.0 * upper;
+    DDoubleVec<N> r = choose(odd, sk, ck);
+    DoubleVec<N> sign = 1.0 - 2.0 * upper;
+    return DDoubleVec<N>(sign * r.hi(), sign * r.lo());
+}
+
+template <int N>
+static void sincos_kernel(DDoubleVec<N> x, DDoubleVec<N> &s, DDoubleVec<N> &c)
+{
+    DoubleVec<N> sector;
+    x = remainder_pi2(x, sector);
+    DDoubleVec<N> sk = sin_kernel(x);
+    DDoubleVec<N> ck = cos_kernel(x);
+    s = sin_sector(sector, sk, ck);
+    c = sin_sector(mod4(sector + 1.0), sk, ck);
+}
+
+static bool sincos_special(DDouble x) { return !(std::fabs(x.hi()) < 1e15); }
+
+struct SinBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const
+    {
+        DDoubleVec<N> s, c;
+        sincos_kernel(x, s, c);
+        return s;
+    }
+    DDouble operator()(DDouble x) const { return sin(x); }
+    bool special(DDouble x) const { return sincos_special(x); }
+};
+
+struct CosBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const
+    {
+        DDoubleVec<N> s, c;
+        sincos_kernel(x, s, c);
+        return c;
+    }
+    DDouble operator()(DDouble x) const { return cos(x); }
+    bool special(DDouble x) const { return sincos_special(x); }
+};
+
+struct TanBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const
+    {
+        DDoubleVec<N> s, c;
+        sincos_kernel(x, s, c);
+        return s / c;
+    }
+    DDouble operator()(DDouble x) const { return tan(x); }
+    bool special(DDouble x) const { return sincos_special(x); }
+};
+
+XPREC_API_EXPORT
+void sin(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, SinBatch());
+}
+
+XPREC_API_EXPORT
+void cos(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, CosBatch());
+}
+
+XPREC_API_EXPORT
+void tan(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, TanBatch());
+}
+
+XPREC_API_EXPORT
+void sincos(const DDouble *x, DDouble *s, DDouble *c, size_t n)
+{
+    const int N = XPREC_BATCH_WIDTH;
+    size_t i = 0;
+    for (; i + N <= n; i += N) {
+        // Check for special lanes before the store, which may overwrite x
+        DDoubleVec<N> xv = DDoubleVec<N>::load(x + i);
+        bool any_special = false;
+        for (int k = 0; k != N; ++k)
+            any_special |= sincos_special(x[i + k]);
+
+        DDoubleVec<N> sv, cv;
+        sincos_kernel(xv, sv, cv);
+        sv.store(s + i);
+        cv.store(c + i);
+        if (any_special) {
+            for (int k = 0; k != N; ++k) {
+                DDouble xk = xv[k];
+                if (sincos_special(xk))
+                    sincos(xk, s[i + k], c[i + k]);
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        DDouble xi = x[i];
+        sincos(xi, s[i], c[i]);
+    }
+}
+
 } // namespace xprec
@@ -0,0 +1,304 @@
+/* Clenshaw-Curtis and Fejer quadrature
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/ddouble.h"
+#include "xprec/numbers.h"
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace xprec {
+
+/** Complex number for the FFT */
+struct FFTComplex {
+    DDouble re, im;
+};
+
+static FFTComplex fft_mul(FFTComplex a, FFTComplex b)
+{
+    FFTComplex r;
+    r.re = a.re * b.re - a.im * b.im;
+    r.im = a.re * b.im + a.im * b.re;
+    return r;
+}
+
+/** Root of unity exp(i pi p/q) for integers p and q > 0 */
+static FFTComplex fft_root(long long p, long long q)
+{
+    // Reduce to [0, 2pi) first, so that the argument stays small
+    p %= 2 * q;
+    if (p < 0)
+        p += 2 * q;
+
+    FFTComplex r;
+    sincos(numbers::pi * (DDouble((double)p) / (double)q), r.im, r.re);
+    return r;
+}
+
+/**
+ * Roots of unity root[k] = exp(-2 pi i k/n) for k < n/2 and n a power of two.
+ *
+ * Only the first octant is computed with sincos(), the rest follows from
+ * symmetry.
+ */
+static std::vector<FFTComplex> fft_roots(size_t n)
+{
+    std::vector<FFTComplex> root(n / 2);
+    const size_t eighth = n / 8, quarter = n / 4;
+    for (size_t k = 0; k < root.size(); ++k) {
+        if (n < 8 || k <= eighth) {
+            root[k] = fft_root(-2 * (long long)k, n);
+        } else if (k <= quarter) {
+            root[k].re = -root[quarter - k].im;
+            root[k].im = -root[quarter - k].re;
+        } else {
+            root[k].re = root[k - quarter].im;
+            root[k].im = -root[k - quarter].re;
+        }
+    }
+    return root;
+}
+
+/**
+ * In-place FFT of power-of-two size, computing
+ * X[j] = sum_k a[k] exp(sign * 2 pi i jk/n) without normalization, where root
+ * is the table from fft_roots().
+ */
+static void fft_pow2(std::vector<FFTComplex> &a,
+                     const std::vector<FFTComplex> &root, int sign)
+{
+    const size_t n = a.size();
+    assert((n & (n - 1)) == 0 && root.size() == n / 2);
+
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t half = len / 2, step = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                FFTComplex &lo = a[i + k], &hi = a[i + k + half];
+                FFTComplex r = root[k * step];
+                if (sign > 0)
+                    r.im = -r.im;
+                FFTComplex t = fft_mul(r, hi);
+                hi.re = lo.re - t.re;
+                hi.im = lo.im - t.im;
+                lo.re += t.re;
+                lo.im += t.im;
+            }
+        }
+    }
+}
+
+/**
+ * In-place FFT of any size, computing
+ * X[j] = sum_k a[k] exp(sign * 2 pi i jk/n) without normalization.
+ *
+ * Sizes other than powers of two are reduced to a convolution of
+ * power-of-two size using Bluestein's algorithm, since jk = (j^2 + k^2 -
+ * (j - k)^2) / 2.
+ */
+static void fft(std::vector<FFTComplex> &a, int sign)
+{
+    const size_t n = a.size();
+    if ((n & (n - 1)) == 0) {
+        fft_pow2(a, fft_roots(n), sign);
+        return;
+    }
+
+    size_t m = 1;
+    while (m < 2 * n - 1)
+        m <<= 1;
+
+    const FFTComplex zero = {0.0, 0.0};
+    std::vector<FFTComplex> chirp(n), u(m, zero), v(m, zero);
+    for (size_t k = 0; k < n; ++k) {
+        long long k2 = (long long)k * k % (2 * n);
+        chirp[k] = fft_root(sign * k2, n);
+        u[k] = fft_mul(a[k], chirp[k]);
+        v[k].re = chirp[k].re;
+        v[k].im = -chirp[k].im;
+        if (k != 0)
+            v[m - k] = v[k];
+    }
+    const std::vector<FFTComplex> root = fft_roots(m);
+    fft_pow2(u, root, -1);
+    fft_pow2(v, root, -1);
+    for (size_t i = 0; i < m; ++i)
+        u[i] = fft_mul(u[i], v[i]);
+    fft_pow2(u, root, 1);
+
+    const double scale = 1.0 / m;
+    for (size_t j = 0; j < n; ++j) {
+        a[j] = fft_mul(chirp[j], u[j]);
+        a[j].re *= scale;
+        a[j].im *= scale;
+    }
+}
+
+/**
+ * Real part of the inverse DFT, 1/N sum_k v[k] exp(2 pi i jk/N), of
+ * Hermitian v.
+ */
+static std::vector<DDouble> fft_inverse_real(std::vector<FFTComplex> v)
+{
+    const size_t n = v.size();
+    fft(v, 1);
+    std::vector<DDouble> y(n);
+    for (size_t j = 0; j < n; ++j)
+        y[j] = v[j].re / (double)n;
+    return y;
+}
+
+/**
+ * Weights of Fejer's second rule (curtis = false) or the Clenshaw-Curtis
+ * rule (curtis = true) for the nodes cos(k pi/N), k = 0, ..., N-1, following
+ * Waldvogel, BIT 46, 195 (2006).  The weight for k = N equals the one for
+ * k = 0.
+ */
+static std::vector<DDouble> clenshaw_weights(int N, bool curtis)
+{
+    assert(N >= 2);
+    const int l = N / 2, m = N - l;
+
+    // v0[j] are the moments of the odd Chebyshev polynomials
+    std::vector<DDouble> v0(N + 1, 0.0);
+    for (int j = 0; j < l; ++j) {
+        double odd = 2.0 * j + 1.0;
+        v0[j] = 2.0 / DDouble(odd * (odd - 2.0));
+    }
+    v0[l] = 1.0 / DDouble(2.0 * l - 1.0);
+
+    std::vector<FFTComplex> v(N);
+    for (int k = 0; k < N; ++k) {
+        v[k].re = -v0[k] - v0[N - k];
+        v[k].im = 0.0;
+    }
+    if (curtis) {
+        DDouble g = reciprocal(DDouble((double)N * N - 1.0 + N % 2));
+        for (int k = 0; k < N; ++k)
+            v[k].re -= g;
+        v[l].re += (double)N * g;
+        v[m].re += (double)N * g;
+    }
+    return fft_inverse_real(v);
+}
+
+/**
+ * Weights of Fejer's first rule for the nodes cos((k + 1/2) pi/N),
+ * k = 0, ..., N-1, following Waldvogel, BIT 46, 195 (2006).
+ */
+static std::vector<DDouble> fejer1_weights(int N)
+{
+    assert(N >= 1);
+    const int l = N / 2, m = N - l;
+
+    const FFTComplex zero = {0.0, 0.0};
+    std::vector<FFTComplex> v0(N + 1, zero);
+    for (int k = 0; k < m; ++k) {
+        DDouble moment = 2.0 / DDouble(1.0 - 4.0 * k * k);
+        v0[k] = fft_root(k, N);
+        v0[k].re *= moment;
+        v0[k].im *= moment;
+    }
+
+    std::vector<FFTComplex> v(N);
+    for (int k = 0; k < N; ++k) {
+        v[k].re = v0[k].re + v0[N - k].re;
+        v[k].im = v0[k].im - v0[N - k].im;
+    }
+    return fft_inverse_real(v);
+}
+
+/** Node sin(pi/2 * p/q) = cos(pi/2 * (q - p)/q) with full relative accuracy */
+static DDouble clenshaw_node(int p, int q)
+{
+    return sin(numbers::pi_half * (DDouble((double)p) / (double)q));
+}
+
+XPREC_API_EXPORT
+void clenshaw_curtis(int n, DDouble x[], DDouble w[])
+{
+    if (n < 1)
+        return;
+    if (n == 1) {
+        x[0] = 0.0;
+        if (w != nullptr)
+            w[0] = 2.0;
+        return;
+    }
+
+    // Nodes x[i] = -cos(i pi/N), where N = n - 1 is the number of intervals
+    const int N = n - 1;
+    for (int i = n / 2; i < n; ++i) {
+        x[i] = clenshaw_node(2 * i - N, N);
+        x[n - 1 - i] = -x[i];
+    }
+    if (n % 2 == 1)
+        x[n / 2] = 0.0;
+    if (w == nullptr)
+        return;
+
+    if (N == 1) {
+        w[0] = w[1] = 1.0;
+        return;
+    }
+    std::vector<DDouble> wk = clenshaw_weights(N, true);
+    for (int i = n / 2; i < n; ++i) {
+        w[i] = i == N ? wk[0] : wk[N - i];
+        w[n - 1 - i] = w[i];
+    }
+}
+
+XPREC_API_EXPORT
+void fejer1(int n, DDouble x[], DDouble w[])
+{
+    if (n < 1)
+        return;
+
+    gauss_chebyshev(n, x);
+    if (w == nullptr)
+        return;
+
+    std::vector<DDouble> wk = fejer1_weights(n);
+    for (int i = n / 2; i < n; ++i) {
+        w[i] = wk[n - 1 - i];
+        w[n - 1 - i] = w[i];
+    }
+}
+
+XPREC_API_EXPORT
+void fejer2(int n, DDouble x[], DDouble w[])
+{
+    if (n < 1)
+        return;
+
+    // Nodes x[i] = -cos((i + 1) pi/N), where N = n + 1
+    const int N = n + 1;
+    for (int i = n / 2; i < n; ++i) {
+        x[i] = clenshaw_node(2 * i + 2 - N, N);
+        x[n - 1 - i] = -x[i];
+    }
+    if (n % 2 == 1)
+        x[n / 2] = 0.0;
+    if (w == nullptr)
+        return;
+
+    std::vector<DDouble> wk = clenshaw_weights(N, false);
+    for (int i = n / 2; i < n; ++i) {
+        w[i] = wk[N - 1 - i];
+        w[n - 1 - i] = w[i];
+    }
+}
+
+} /* namespace xprec */
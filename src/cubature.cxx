@@ -0,0 +1,205 @@
+/* Tensor-product and sparse-grid quadrature in several dimensions.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "parallel.h"
+#include "xprec/cubature.h"
+#include "xprec/ddouble.h"
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace xprec {
+
+/** Maximum number of nodes in a tile of a tensor-product rule */
+static const size_t CUBATURE_TILE = 64;
+
+/**
+ * Number of nodes evaluated with one call to the integrand, which should be
+ * large enough to amortize the overhead of the call.
+ */
+static const size_t CUBATURE_BATCH = 256;
+
+XPREC_API_EXPORT
+CubatureRule::CubatureRule(std::vector<DDoubleArray> x, DDoubleArray w)
+    : _x(std::move(x))
+    , _w(std::move(w))
+{
+    assert(!_x.empty());
+    for (size_t k = 0; k != _x.size(); ++k)
+        assert(_x[k].size() == _w.size());
+}
+
+/**
+ * Advance the multi-index i to the next one in row-major order, where
+ * 0 <= i[k] < extent[k].  Returns false after the last one.
+ */
+static bool cubature_next(std::vector<int> &i, const std::vector<int> &extent)
+{
+    for (int k = (int)i.size() - 1; k >= 0; --k) {
+        if (++i[k] < extent[k])
+            return true;
+        i[k] = 0;
+    }
+    return false;
+}
+
+XPREC_API_EXPORT
+CubatureRule tensor_rule(QuadratureCache::Family family, int dim, int n)
+{
+    assert(dim >= 1 && n >= 1);
+    std::shared_ptr<const QuadratureRule> rule =
+        QuadratureCache::global().get(family, n);
+
+    // Largest side of the tile such that side^dim <= CUBATURE_TILE
+    size_t total = 1;
+    int side = 1;
+    for (int k = 0; k < dim; ++k)
+        total *= n;
+    for (;;) {
+        size_t tile = 1;
+        for (int k = 0; k < dim; ++k)
+            tile *= side + 1;
+        if (tile > CUBATURE_TILE || side >= n)
+            break;
+        ++side;
+    }
+
+    std::vector<DDoubleArray> x(dim, DDoubleArray(total));
+    DDoubleArray w(total);
+    std::vector<int> tiles(dim, (n + side - 1) / side), tile(dim, 0);
+    size_t pos = 0;
+    do {
+        std::vector<int> extent(dim), local(dim, 0);
+        for (int k = 0; k < dim; ++k)
+            extent[k] = std::min(side, n - tile[k] * side);
+        do {
+            DDouble wi = 1.0;
+            for (int k = 0; k < dim; ++k) {
+                int j = tile[k] * side + local[k];
+                x[k].set(pos, rule->x()[j]);
+                wi *= rule->w()[j];
+            }
+            w.set(pos, wi);
+            ++pos;
+        } while (cubature_next(local, extent));
+    } while (cubature_next(tile, tiles));
+    assert(pos == total);
+    return CubatureRule(std::move(x), std::move(w));
+}
+
+XPREC_API_EXPORT
+CubatureRule smolyak_rule(QuadratureCache::Family family, int dim, int level)
+{
+    assert(dim >= 1 && level >= 0);
+
+    // Combination technique: the tensor product of levels l enters with
+    // coefficient (-1)^(level - |l|) binom(dim - 1, level - |l|).
+    std::map<std::vector<DDouble>, DDouble> nodes;
+    std::vector<int> l(dim, 0), levels(dim, level + 1);
+    do {
+        int sum = 0;
+        for (int k = 0; k < dim; ++k)
+            sum += l[k];
+        int q = level - sum;
+        if (q < 0 || q >= dim)
+            continue;
+
+        double coeff = q % 2 == 0 ? 1.0 : -1.0;
+        for (int j = 1; j <= q; ++j)
+            coeff = coeff * (dim - j) / j;
+
+        std::vector<std::shared_ptr<const QuadratureRule>> rules(dim);
+        std::vector<int> sizes(dim), i(dim, 0);
+        for (int k = 0; k < dim; ++k) {
+            sizes[k] = l[k] + 1;
+            rules[k] = QuadratureCache::global().get(family, sizes[k]);
+        }
+        std::vector<DDouble> key(dim);
+        do {
+            DDouble wi = coeff;
+            for (int k = 0; k < dim; ++k) {
+                key[k] = rules[k]->x()[i[k]];
+                wi *= rules[k]->w()[i[k]];
+            }
+            nodes[key] += wi;
+        } while (cubature_next(i, sizes));
+    } while (cubature_next(l, levels));
+
+    std::vector<DDoubleArray> x(dim, DDoubleArray(nodes.size()));
+    DDoubleArray w(nodes.size());
+    size_t pos = 0;
+    for (const auto &node : nodes) {
+        for (int k = 0; k < dim; ++k)
+            x[k].set(pos, node.first[k]);
+        w.set(pos, node.second);
+        ++pos;
+    }
+    return CubatureRule(std::move(x), std::move(w));
+}
+
+/**
+ * Map count nodes starting at begin onto the box, evaluate f on them with one
+ * call, and return the weighted sum; runs on worker threads.
+ */
+static DDouble cubature_batch(const CubatureIntegrand &f,
+                              const CubatureRule &rule,
+                              const std::vector<DDouble> &center,
+                              const std::vector<DDouble> &half, size_t begin,
+                              size_t count)
+{
+    const int dim = rule.dim();
+    std::vector<DDouble> x(dim * count), fx(count);
+    std::vector<const DDouble *> ptr(dim);
+    for (int k = 0; k < dim; ++k) {
+        DDouble *xk = &x[k * count];
+        const DDoubleArray &rx = rule.x(k);
+        for (size_t i = 0; i != count; ++i)
+            xk[i] = center[k] + half[k] * rx[begin + i];
+        ptr[k] = xk;
+    }
+    f(ptr.data(), fx.data(), count);
+
+    DDouble sum = 0.0;
+    const DDoubleArray &w = rule.w();
+    for (size_t i = 0; i != count; ++i)
+        sum += w[begin + i] * fx[i];
+    return sum;
+}
+
+XPREC_API_EXPORT
+DDouble cubature(const CubatureIntegrand &f, const CubatureRule &rule,
+                 const DDouble *a, const DDouble *b, unsigned nthreads)
+{
+    const int dim = rule.dim();
+    std::vector<DDouble> center(dim), half(dim);
+    DDouble volume = 1.0;
+    for (int k = 0; k < dim; ++k) {
+        center[k] = 0.5 * (a[k] + b[k]);
+        half[k] = 0.5 * (b[k] - a[k]);
+        volume *= half[k];
+    }
+    if (nthreads == 0)
+        nthreads = max_threads();
+
+    const size_t n = rule.size();
+    const size_t tasks = (n + CUBATURE_BATCH - 1) / CUBATURE_BATCH;
+    std::vector<DDouble> partial(tasks);
+    parallel_for(tasks, nthreads, [&](size_t t) {
+        size_t begin = t * CUBATURE_BATCH;
+        size_t count = std::min(CUBATURE_BATCH, n - begin);
+        partial[t] = cubature_batch(f, rule, center, half, begin, count);
+    });
+
+    DDouble sum = 0.0;
+    for (const DDouble &p : partial)
+        sum += p;
+    return volume * sum;
+}
+
+} /* namespace xprec */
@@ -7,14 +7,14 @@
  * Copyright (C) 2018-2023 Julia Math
  * and also licensed MIT
  */
+#include "batch.h"
+#include "export.h"
 #include "taylor.h"
 #include "xprec/ddouble.h"
+#include "xprec/simd.h"
+#include <algorithm>
 #include <cassert>
 
-#ifndef XPREC_API_EXPORT
-#define XPREC_API_EXPORT
-#endif
-
 namespace xprec {
 
 inline DDouble expm1_kernel_taylor(DDouble x, int n)
@@ -40,75 +40,76 @@ inline DDouble expm1_kernel_taylor(DDouble x, int n)
     return r;
 }
 
+// expm1(n/128) for n = -32, ..., 32
+static const DDouble EXPM1_128TH[65] = {
+    {-0.22119921692859512, -1.0231869534531498e-17},
+    {-0.2150910066825083, 2.3730789082448644e-18},
+    {-0.20893488914970398, -1.2452907836084123e-18},
+    {-0.20273048858867557, -1.7352379329257716e-18},
+    {-0.19647742631093926, -8.86329269357526e-18},
+    {-0.1901753206579207, -5.503037155875603e-18},
+    {-0.18382378697766022, 6.554697808700811e-18},
+    {-0.17742243760133541, 4.017189331283796e-18},
+    {-0.17097088181959966, 1.5116689608969005e-19},
+    {-0.16446872585873493, -2.139647400453233e-18},
+    {-0.15791557285661764, -1.1212311825056607e-17},
+    {-0.15131102283849604, -5.6669249355115135e-18},
+    {-0.14465467269257745, -1.0550675610571318e-17},
+    {-0.1379461161454243, 5.763785158040174e-18},
+    {-0.13118494373715683, 6.146598011714697e-19},
+    {-0.12437074279646179, 6.303176605470021e-18},
+    {-0.1175030974154046, 3.2658820639011965e-18},
+    {-0.11058158842404436, -2.0874178115990373e-19},
+    {-0.10360579336484958, -5.827134285622915e-18},
+    {-0.09657528646691328, -6.93416919089852e-18},
+    {-0.08948963861996587, -5.494907630146725e-18},
+    {-0.08234841734818418, -4.8348859420484686e-18},
+    {-0.07515118678379516, -3.2635260492015698e-18},
+    {-0.06789750764047242, -1.167464604196626e-18},
+    {-0.06058693718652421, -7.077887227488846e-19},
+    {-0.053219029217871104, 7.855973989608505e-19},
+    {-0.045793334030811685, 7.6989787849942455e-19},
+    {-0.03830939839457471, 3.351106556546642e-18},
+    {-0.03076676552365592, 5.607402565184088e-19},
+    {-0.023164975049937968, 1.6576088297760018e-18},
+    {-0.015503562994591593, -6.554927149823924e-19},
+    {-0.007782061739756488, -2.171849242067691e-19},
+    {0.0, 0.0},
+    {0.007843097206447977, 6.611915286438626e-19},
+    {0.015747708586685748, -2.862138367894185e-19},
+    {0.023714316602357916, 7.772270440766338e-19},
+    {0.03174340749910267, 7.614433403626514e-19},
+    {0.03983547133623, 1.1038442468719412e-18},
+    {0.0479910020166327, 2.232142242481688e-18},
+    {0.05621049731693197, -6.970919938961464e-19},
+    {0.06449445891785943, -2.2934210303960824e-18},
+    {0.07284339243487745, -2.006173739106304e-18},
+    {0.0812578074490396, 4.627898188856025e-18},
+    {0.08973821753809323, -7.438154204619872e-19},
+    {0.09828514030782586, -6.438065156763691e-18},
+    {0.10689909742365748, 2.1251455338215007e-19},
+    {0.11558061464248076, -2.5290380495681964e-18},
+    {0.12433022184475072, -1.0222490708858767e-18},
+    {0.13314845306682632, -5.370737708558031e-18},
+    {0.1420358465335656, -1.2069701773647767e-17},
+    {0.15099294469117644, 9.857598007072166e-18},
+    {0.16002029424032516, -9.002941214515411e-18},
+    {0.16911844616950442, -1.3811845173682628e-17},
+    {0.17828795578866324, -1.1203883895767038e-18},
+    {0.1875293827631006, 6.415816207759217e-19},
+    {0.19684329114762478, -5.89991778046089e-18},
+    {0.2062302494209807, 1.1540139455476613e-17},
+    {0.21569083052054744, 1.3287595785286163e-17},
+    {0.22522561187730758, -4.729368350680563e-19},
+    {0.234835175451091, -3.104366491258746e-19},
+    {0.24452010776609515, 8.861603894276184e-18},
+    {0.25428099994668374, 1.3050032175111173e-17},
+    {0.2641184477534664, -1.541497933603795e-17},
+    {0.2740330516196609, 2.3636421950197868e-17},
+    {0.2840254166877415, -2.133257464457841e-17}};
+
 static DDouble expm1_128th(int n)
 {
-    static const DDouble EXPM1_128TH[65] = {
-        {-0.22119921692859512, -1.0231869534531498e-17},
-        {-0.2150910066825083, 2.3730789082448644e-18},
-        {-0.20893488914970398, -1.2452907836084123e-18},
-        {-0.20273048858867557, -1.7352379329257716e-18},
-        {-0.19647742631093926, -8.86329269357526e-18},
-        {-0.1901753206579207, -5.503037155875603e-18},
-        {-0.18382378697766022, 6.554697808700811e-18},
-        {-0.17742243760133541, 4.017189331283796e-18},
-        {-0.17097088181959966, 1.5116689608969005e-19},
-        {-0.16446872585873493, -2.139647400453233e-18},
-        {-0.15791557285661764, -1.1212311825056607e-17},
-        {-0.15131102283849604, -5.6669249355115135e-18},
-        {-0.14465467269257745, -1.0550675610571318e-17},
-        {-0.1379461161454243, 5.763785158040174e-18},
-        {-0.13118494373715683, 6.146598011714697e-19},
-        {-0.12437074279646179, 6.303176605470021e-18},
-        {-0.1175030974154046, 3.2658820639011965e-18},
-        {-0.11058158842404436, -2.0874178115990373e-19},
-        {-0.10360579336484958, -5.827134285622915e-18},
-        {-0.09657528646691328, -6.93416919089852e-18},
-        {-0.08948963861996587, -5.494907630146725e-18},
-        {-0.08234841734818418, -4.8348859420484686e-18},
-        {-0.07515118678379516, -3.2635260492015698e-18},
-        {-0.06789750764047242, -1.167464604196626e-18},
-        {-0.06058693718652421, -7.077887227488846e-19},
-        {-0.053219029217871104, 7.855973989608505e-19},
-        {-0.045793334030811685, 7.6989787849942455e-19},
-        {-0.03830939839457471, 3.351106556546642e-18},
-        {-0.03076676552365592, 5.607402565184088e-19},
-        {-0.023164975049937968, 1.6576088297760018e-18},
-        {-0.015503562994591593, -6.554927149823924e-19},
-        {-0.007782061739756488, -2.171849242067691e-19},
-        {0.0, 0.0},
-        {0.007843097206447977, 6.611915286438626e-19},
-        {0.015747708586685748, -2.862138367894185e-19},
-        {0.023714316602357916, 7.772270440766338e-19},
-        {0.03174340749910267, 7.614433403626514e-19},
-        {0.03983547133623, 1.1038442468719412e-18},
-        {0.0479910020166327, 2.232142242481688e-18},
-        {0.05621049731693197, -6.970919938961464e-19},
-        {0.06449445891785943, -2.2934210303960824e-18},
-        {0.07284339243487745, -2.006173739106304e-18},
-        {0.0812578074490396, 4.627898188856025e-18},
-        {0.08973821753809323, -7.438154204619872e-19},
-        {0.09828514030782586, -6.438065156763691e-18},
-        {0.10689909742365748, 2.1251455338215007e-19},
-        {0.11558061464248076, -2.5290380495681964e-18},
-        {0.12433022184475072, -1.0222490708858767e-18},
-        {0.13314845306682632, -5.370737708558031e-18},
-        {0.1420358465335656, -1.2069701773647767e-17},
-        {0.15099294469117644, 9.857598007072166e-18},
-        {0.16002029424032516, -9.002941214515411e-18},
-        {0.16911844616950442, -1.3811845173682628e-17},
-        {0.17828795578866324, -1.1203883895767038e-18},
-        {0.1875293827631006, 6.415816207759217e-19},
-        {0.19684329114762478, -5.89991778046089e-18},
-        {0.2062302494209807, 1.1540139455476613e-17},
-        {0.21569083052054744, 1.3287595785286163e-17},
-        {0.22522561187730758, -4.729368350680563e-19},
-        {0.234835175451091, -3.104366491258746e-19},
-        {0.24452010776609515, 8.861603894276184e-18},
-        {0.25428099994668374, 1.3050032175111173e-17},
-        {0.2641184477534664, -1.541497933603795e-17},
-        {0.2740330516196609, 2.3636421950197868e-17},
-        {0.2840254166877415, -2.133257464457841e-17}};
-
     assert(abs(n) <= 32);
     return EXPM1_128TH[n + 32];
 }
@@ -136,124 +137,162 @@ static DDouble expm1_quarter(DDouble x)
     return expm1_x0.add_small(exp_x0 * exp_y);
 }
 
-class Product {
-public:
-    constexpr Product() : _isempty(true), _res(1) { }
-
-    template <typename T>
-    Product &operator*=(const T &x)
-    {
-        if (_isempty)
-            _res = x;
-        else
-            _res *= x;
-
-        _isempty = false;
-        return *this;
-    }
-
-    constexpr operator DDouble() const { return _res; }
-
-private:
-    bool _isempty;
-    DDouble _res;
-};
-
-static DDouble exp_halves(int x)
+// 2^(j/128) - 1 for j = -64, ..., 63
+static const DDouble EXP2M1_128TH[128] = {
+    {-0.2928932188134525, 7.174684663993261e-18},
+    {-0.2890536989154172, -8.038914457945122e-18},
+    {-0.285193330804015, -6.0158212445268276e-18},
+    {-0.2813120012755088, -2.1020170082337783e-17},
+    {-0.2774095965114767, -1.5118790674969937e-17},
+    {-0.27348600207547374, 2.66114081842773e-17},
+    {-0.26954110290967653, 2.7509265300881745e-17},
+    {-0.265574783331509, -1.318173744858969e-17},
+    {-0.2615869270302503, -1.741997278446398e-17},
+    {-0.25757741706362375, -1.6107174092204261e-18},
+    {-0.2535461358543676, 7.096460077142018e-18},
+    {-0.24949296518678724, -4.31326076332226e-18},
+    {-0.24541778620328863, 4.688384843543075e-18},
+    {-0.24132047940089266, 6.212078255412209e-18},
+    {-0.23720092462773085, 3.8644266954502085e-19},
+    {-0.233059001079522, -1.1135017009065593e-17},
+    {-0.2288945872960296, 1.199359843285919e-17},
+    {-0.2247075611575, -7.300353295344693e-18},
+    {-0.2204977998810815, -8.849540348841276e-18},
+    {-0.21626518001722356, 3.750842387009219e-18},
+    {-0.21200957744605675, -5.068458235639152e-18},
+    {-0.20773086737375313, -9.668858517292851e-18},
+    {-0.20342892432886656, 5.039118519698011e-18},
+    {-0.19910362215865332, -2.5190116520100086e-18},
+    {-0.19475483402537286, 1.2353596284898944e-17},
+    {-0.19038243240256814, 1.0470667077114546e-17},
+    {-0.1859862890713261, -5.809199807906506e-18},
+    {-0.18156627511651777, 1.0736049740970466e-17},
+    {-0.17712226092301758, 4.882751662883964e-18},
+    {-0.1726541161719028, -7.294679715277685e-18},
+    {-0.16816170983663178, 1.699387867936586e-18},
+    {-0.1636449101792017, 3.719957926310978e-19},
+    {-0.15910358474628547, 1.3239474487278572e-17},
+    {-0.15453760036534742, 7.162793859283428e-18},
+    {-0.14994682314073826, -4.01185968519885e-18},
+    {-0.1453311184497686, 6.167253948093172e-18},
+    {-0.14069035093876103, -9.256902091315555e-18},
+    {-0.13602438451908122, 1.7562419252346148e-18},
+    {-0.13133308236314686, -1.1933629119164127e-17},
+    {-0.12661630690041553, 1.749698813720255e-18},
+    {-0.12187391981335026, 9.229156694299104e-19},
+    {-0.1171057820333636, 5.67321166697297e-18},
+    {-0.11231175373673938, 4.393083367153945e-18},
+    {-0.1074916943405325, -6.2125877472988e-18},
+    {-0.1026454624984464, -4.7640585938584126e-18},
+    {-0.09777291609668806, 1.869463571662324e-18},
+    {-0.09287391224980063, 5.66349353665608e-18},
+    {-0.08794830729647335, 4.713011919872412e-18},
+    {-0.08299595679532877, 2.537748313413679e-18},
+    {-0.07801671552068704, -1.94313451912091e-18},
+    {-0.07301043745830721, -6.701713777619857e-18},
+    {-0.06797697580110548, 4.948987787473942e-18},
+    {-0.06291618294485005, -2.8582414493917966e-18},
+    {-0.057827910483832776, 5.00397795774813e-19},
+    {-0.05271200920651718, 3.1392298682681924e-18},
+    {-0.047568329091162896, -2.025181945944751e-18},
+    {-0.042396719301426355, 2.4114209502780123e-18},
+    {-0.037197028181937535, -1.0025615211181075e-18},
+    {-0.03196910325385278, 3.089672476031033e-18},
+    {-0.026712791210383356, -6.393577718667539e-19},
+    {-0.021427937912299865, -2.989714202136461e-19},
+    {-0.01611438838341211, 4.670642216485574e-19},
+    {-0.010771986806024515, -6.223051570826017e-19},
+    {-0.005400576516366824, -2.342423707574178e-19},
+    {0.0, 0.0},
+    {0.005429901112802822, -4.1792582417406993e-19},
+    {0.01088928605170046, 3.7773268042268547e-19},
+    {0.016378314910953037, 1.2588974512148405e-18},
+    {0.02189714865411668, -9.494539895697731e-19},
+    {0.027445949118763698, -9.884844191031042e-19},
+    {0.03302487902122842, 6.619449701198605e-19},
+    {0.03863410196137879, -2.487307246639953e-18},
+    {0.04427378242741384, 2.252170208492904e-18},
+    {0.049944085800687266, 4.182272500122047e-19},
+    {0.05564517836055716, 1.759325738772092e-18},
+    {0.06137722728926208, 1.9042507224487988e-18},
+    {0.06714040067682361, 4.268187178470922e-18},
+    {0.07293486752597556, -3.839668843358824e-18},
+    {0.07876079775711979, 2.8223346785063543e-18},
+    {0.08461836221330923, 3.905952842534547e-18},
+    {0.09050773266525766, -2.712245182495796e-18},
+    {0.09642908181637683, -3.6881836132353304e-18},
+    {0.10238258330784095, -2.8507825155508824e-18},
+    {0.10836841172367864, -4.601411604918528e-18},
+    {0.11438674259589254, -6.919517894059943e-18},
+    {0.12043775240960669, -6.499707834283954e-18},
+    {0.1265216186082419, -3.8525836433032604e-18},
+    {0.13263851959871922, 4.617986051751087e-18},
+    {0.13878863475669165, 5.861399913367335e-18},
+    {0.14497214443180423, -9.09825230955772e-18},
+    {0.1511892299529827, 4.751526573009359e-18},
+    {0.15744007363375104, -7.971985464457258e-18},
+    {0.1637248587775775, 1.0536472753612021e-17},
+    {0.1700437696832502, -1.8477442017900047e-18},
+    {0.17639699165028128, 3.088131092296112e-20},
+    {0.18278471098434104, -1.2325821314838153e-17},
+    {0.18920711500272105, 1.2064576699027549e-17},
+    {0.19566439203982738, -9.345114526443012e-18},
+    {0.20215673145270313, 1.0938663761265181e-17},
+    {0.20868432362658157, 8.043891778967983e-18},
+    {0.21524735998046887, 6.140419920071864e-18},
+    {0.2218460329727575, 4.912090348488744e-18},
+    {0.22848053610687, 8.767759302603614e-18},
+    {0.2351510639369333, 3.469859019437239e-18},
+    {0.24185781207348406, -8.930875312888462e-18},
+    {0.24860097718920474, 6.4861685666710185e-19},
+    {0.2553807570246911, -6.7113898212968784e-18},
+    {0.2621973503942507, 2.4666502356519365e-17},
+    {0.2690509571917332, 2.667932131342186e-18},
+    {0.2759417783963921, -1.1868000020372746e-17},
+    {0.28287001607877826, 1.713594918243561e-17},
+    {0.28983587340666583, -2.1529727153539737e-17},
+    {0.29683955465100964, 2.5382502794888315e-17},
+    {0.3038812651919359, -2.4545546479836942e-17},
+    {0.31096121152476436, -1.6304210123936712e-17},
+    {0.318079601266064, 9.315929597662924e-19},
+    {0.32523664315974127, 2.6923839130869213e-17},
+    {0.33243254708316144, 4.495284922090389e-18},
+    {0.339667524053303, -2.1749476514198334e-17},
+    {0.34694178623294586, -2.3270500218711038e-17},
+    {0.3542555469368927, 2.1498332566772065e-17},
+    {0.36160902063822475, 1.533787661270668e-18},
+    {0.3690024229745906, -1.5084323271327172e-17},
+    {0.3764359707545301, -1.3474738127460185e-17},
+    {0.38390988196383197, -1.2193965356690036e-17},
+    {0.3914243757719262, 6.4494025783679345e-18},
+    {0.3989796725383111, 1.4880170372002426e-17},
+    {0.40657599381901544, 7.034914812136422e-18}};
+
+// ln(2)/128 split into three parts, where the first one has only 36
+// significant bits, so its product with any integer below 2^17 is exact.
+static const double LN2_128TH_1 = 0.005415212348111709;
+static const double LN2_128TH_2 = 1.2864023111638346e-14;
+static const double LN2_128TH_3 = -7.8733977624258935e-31;
+
+/**
+ * Reduce x = (128 k + j) ln(2)/128 + r, where abs(j) <= 64 and abs(r) <=
+ * ln(2)/256, and return s = exp(x - k ln(2)) - 1, such that
+ * exp(x) = 2^k (1 + s).  Valid for abs(x) < 709.
+ */
+static DDouble exp_reduce(DDouble x, int &k)
 {
-    const static DDouble EXP_HALVES[31] = {
-        {1.6487212707001282, -4.731568479435833e-17},
-        {2.718281828459045, 1.4456468917292502e-16},
-        {4.4816890703380645, 3.0481759556536343e-16},
-        {7.38905609893065, -1.7971139497839148e-16},
-        {12.182493960703473, 2.0334002173348147e-16},
-        {20.085536923187668, -1.8275625525512858e-16},
-        {33.11545195869231, 2.2435601403927554e-15},
-        {54.598150033144236, 2.8741578015844115e-15},
-        {90.01713130052181, 2.550844346114049e-15},
-        {148.4131591025766, 3.4863514900464198e-15},
-        {244.69193226422038, 4.129320187450839e-15},
-        {403.4287934927351, 1.2359628024450387e-14},
-        {665.1416330443618, 2.990469256473133e-14},
-        {1096.6331584284585, 9.869752640434095e-14},
-        {1808.0424144560632, 3.6612201665204784e-14},
-        {2980.9579870417283, -2.7103295816873633e-14},
-        {4914.768840299134, 2.17317454126359e-14},
-        {8103.083927575384, -2.1530877621067177e-13},
-        {13359.726829661873, -8.496858340658619e-13},
-        {22026.465794806718, -1.3780134700517372e-12},
-        {36315.502674246636, 1.577797006387782e-12},
-        {59874.14171519782, 1.7895764888916994e-12},
-        {98715.7710107605, 3.036676373480473e-12},
-        {162754.79141900392, 5.30065881322063e-12},
-        {268337.2865208745, -2.0035114163950887e-11},
-        {442413.3920089205, 1.2118711752313224e-11},
-        {729416.3698477013, 5.1483277361034595e-11},
-        {1.2026042841647768e6, -1.5000525764327354e-11},
-        {1.9827592635375687e6, 2.845770459793355e-11},
-        {3.2690173724721107e6, -3.075806431120808e-11},
-        {5.389698476283012e6, 4.098121666636582e-10}};
-    const static DDouble EXP_SIXTEENS[44] = {
-        {8.886110520507872e6, 5.321182483501564e-10},
-        {7.896296018268069e13, 0.007660978022635108},
-        {7.016735912097631e20, 30185.471599886117},
-        {6.235149080811617e27, 1.3899738872492847e11},
-        {5.54062238439351e34, 2.1811937023229343e18},
-        {4.923458286012058e41, 1.3869835129739753e25},
-        {4.375039447261341e48, 1.035824156236645e32},
-        {3.887708405994595e55, 2.707966110366217e39},
-        {3.454660656717546e62, 1.8553902103629043e46},
-        {3.0698496406442424e69, 4.375620509828095e52},
-        {2.7279023188106115e76, 6.6492459414351406e59},
-        {2.4240441494100796e83, -3.8332753349400205e66},
-        {2.1540324218248465e90, 6.568050851363196e73},
-        {1.9140970165092822e97, -1.497464557916617e81},
-        {1.700887763567586e104, 1.4773861394382237e88},
-        {1.5114276650041035e111, 1.4805989167614457e94},
-        {1.3430713274979614e118, -6.561438244448466e101},
-        {1.1934680253072109e125, -3.301231394418859e108},
-        {1.0605288775572162e132, 5.4744408887427266e115},
-        {9.423976816163585e138, -2.7555072985830676e122},
-        {8.374249953113352e145, -3.529195534423469e129},
-        {7.441451060972311e152, 4.251237045552673e136},
-        {6.612555656075053e159, -3.4828210031110127e143},
-        {5.875990038289236e166, 7.682543674132907e149},
-        {5.221469689764144e173, -3.041154182825333e157},
-        {4.639855674272614e180, -3.3453058659461497e164},
-        {4.123027032079202e187, 1.8602059512155307e171},
-        {3.663767388609735e194, -1.8555200045340274e178},
-        {3.255664193661862e201, 5.148254191579011e184},
-        {2.8930191842539453e208, -2.8880381060655904e191},
-        {2.5707688209230085e215, 1.1853726094570251e199},
-        {2.2844135865397565e222, 1.3549224944023444e206},
-        {2.0299551604542052e229, 1.2942147572086164e213},
-        {1.803840590747136e236, 1.820681001928355e218},
-        {1.6029126850757262e243, -2.463627227554342e226},
-        {1.4243659274306933e250, -5.204358467973364e233},
-        {1.2657073052794837e257, -3.983584155610672e240},
-        {1.124721500132769e264, -8.843155706148207e247},
-        {9.994399554971195e270, 8.925025806205413e253},
-        {8.881133903158874e277, -4.948247489077345e261},
-        {7.891873741089921e284, 2.4630459641303726e268},
-        {7.012806227721897e291, -1.1759583274063904e275},
-        {6.231657119844268e298, 1.1619020533730335e281},
-        {5.5375193892845935e305, 1.5239358093004245e289}};
-
-    if (x < 0) {
-        return reciprocal(exp_halves(-x));
-    }
-    assert(x <= 1439);
-
-    Product res;
-    int x_halves = x % 32;
-    if (x_halves)
-        res *= EXP_HALVES[x_halves - 1];
-
-    int x_sixteens = x / 32;
-    if (x_sixteens)
-        res *= EXP_SIXTEENS[x_sixteens - 1];
-
-    return res;
+    // Since abs(n) < 2^17, the first two parts of the product are exact.
+    double n = std::round(184.6649652337873 * x.hi());
+    DDouble r = (x - n * LN2_128TH_1) - ExDouble(n) * LN2_128TH_2;
+    r = r.add_small(-n * LN2_128TH_3);
+    k = int(std::floor((n + 64.0) / 128.0));
+    int j = int(n) - 128 * k;
+
+    // (1 + t) (1 + expm1(r)) - 1, where t = 2^(j/128) - 1 is stored
+    // relative to itself, so s is accurate also for small x.
+    DDouble t = EXP2M1_128TH[j + 64];
+    DDouble expm1_r = expm1_kernel_taylor(r, 10);
+    return t + expm1_r * ExDouble(1.0).add_small(t);
 }
 
 XPREC_API_EXPORT
@@ -266,14 +305,9 @@ DDouble exp(DDouble x)
     if (x.hi() <= -709.0)
         return DDouble(0);
 
-    // x = y/2 + z
-    double y = std::round(2 * x.hi());
-    DDouble z = x - y / 2;
-
-    // exp(z + y/2) = (1 + expm1(z)) exp(1/2)^y
-    DDouble exp_z = ExDouble(1.0).add_small(expm1_quarter(z));
-    DDouble exp_y = exp_halves(int(y));
-    return exp_z * exp_y;
+    int k;
+    DDouble s = exp_reduce(x, k);
+    return ldexp(ExDouble(1.0).add_small(s), k);
 }
 
 XPREC_API_EXPORT
@@ -283,50 +317,239 @@ DDouble expm1(DDouble x)
     if (std::fabs(x.hi()) < 0.25)
         return expm1_quarter(x);
 
-    // Otherwise, we do a naive computation
-    DDouble res = exp(x);
+    if (isnan(x))
+        return x;
+    if (x.hi() >= 709.0)
+        return DDouble(INFINITY, 0);
+    if (x.hi() <= -709.0)
+        return DDouble(-1.0);
+
+    // Otherwise, we have expm1(x) = 2^k (1 + s) - 1, and s is the result for
+    // k = 0
+    int k;
+    DDouble s = exp_reduce(x, k);
+    if (k == 0)
+        return s;
+    DDouble res = ldexp(ExDouble(1.0).add_small(s), k);
     if (x.hi() < 75)
         res -= 1.0;
     return res;
 }
 
+// log(1 + k/128) for k = -64, ..., 64
+static const DDouble LOG1P_128TH[129] = {
+    {-0.6931471805599453, -2.3190468138462996e-17},
+    {-0.6776429940239801, 3.8931744894412815e-17},
+    {-0.6623755218931916, -2.21472949355624e-17},
+    {-0.6473376445286511, -4.904308388761765e-17},
+    {-0.6325225587435105, 2.1085297878853066e-17},
+    {-0.6179237593223578, -1.524328452694178e-17},
+    {-0.6035350218702582, 2.6893870159130116e-17},
+    {-0.5893503868783018, 2.3920619442246964e-17},
+    {-0.5753641449035618, -5.214321232885128e-17},
+    {-0.561570822771226, 1.5688108356895506e-17},
+    {-0.5479651707154474, -4.2703624971069435e-17},
+    {-0.5345421503833068, 4.357768696497742e-17},
+    {-0.5212969236332861, -2.9212921959474365e-17},
+    {-0.5082248420659333, 7.588768892523324e-18},
+    {-0.4953214372300254, -1.0369273765482855e-17},
+    {-0.48258241145259567, 3.1570216243602197e-19},
+    {-0.4700036292457356, 2.3229412495470032e-17},
+    {-0.4575811092471784, -2.558480528798173e-17},
+    {-0.44531101665536404, -7.867102101536607e-18},
+    {-0.43318965612301924, -2.4923987486736457e-18},
+    {-0.42121346507630353, -2.2407148500765553e-17},
+    {-0.4093790074293007, 1.1994027281528269e-17},
+    {-0.39768296766610944, 1.067457448873493e-17},
+    {-0.38612214526503347, 2.0000766892692867e-17},
+    {-0.3746934494414107, 3.9243112288632396e-18},
+    {-0.3633938941874773, -2.106844752226605e-17},
+    {-0.3522205935893521, -5.7233316949182485e-18},
+    {-0.34117075740276714, 1.9366790062602867e-17},
+    {-0.33024168687057687, 1.0828321637483858e-17},
+    {-0.3194307707663612, -1.354256857264811e-18},
+    {-0.3087354816496133, 1.6199186085148102e-17},
+    {-0.29815337231907635, 1.720695867445866e-17},
+    {-0.2876820724517809, -2.607160616442564e-17},
+    {-0.27731928541623435, 7.44528405583513e-18},
+    {-0.26706278524904525, 7.32891532732017e-18},
+    {-0.2569104137850272, -2.502843296152504e-17},
+    {-0.24686007793152578, -1.361743371748368e-17},
+    {-0.2369097470783577, -1.9682402978398164e-18},
+    {-0.22705745063534608, -9.551415762738488e-18},
+    {-0.2173012756899814, -1.6168452453763015e-18},
+    {-0.2076393647782445, -1.2053243216686129e-17},
+    {-0.1980699137620938, -3.742843482461439e-18},
+    {-0.18859116980755003, 7.432164219196925e-18},
+    {-0.179201429457711, 1.0785017454858423e-17},
+    {-0.16989903679539747, 4.868008764439071e-19},
+    {-0.16068238169047347, 3.650183553047837e-18},
+    {-0.15154989812720093, -5.1669593684615594e-18},
+    {-0.14250006260728304, 9.926388234225749e-18},
+    {-0.13353139262452263, 3.664457663660085e-18},
+    {-0.1246424452072766, 5.808912678940971e-18},
+    {-0.1158318155251217, -4.338484369808096e-18},
+    {-0.1070981355563671, 1.73705104015906e-18},
+    {-0.09844007281325252, 4.439009633675136e-18},
+    {-0.08985632912186105, 6.273760163689594e-19},
+    {-0.0813456394539524, -5.07707635593117e-18},
+    {-0.07290677080808779, 6.306860257532778e-18},
+    {-0.06453852113757118, 6.470486661692933e-18},
+    {-0.05623971832287608, 3.2835149805605613e-18},
+    {-0.048009219186360606, -1.4390903347292205e-18},
+    {-0.039845908547199674, 3.129547680315208e-18},
+    {-0.0317486983145803, -3.0382263084680858e-18},
+    {-0.023716526617316044, 1.5774243488668215e-18},
+    {-0.015748356968139168, -1.0021578630528974e-18},
+    {-0.007843177461025893, -2.764708154124904e-19},
+    {0.0, 0.0},
+    {0.007782140442054949, -1.2819179123343845e-20},
+    {0.015504186535965254, -3.278321022892429e-19},
+    {0.02316705928153438, -1.1769544932063305e-18},
+    {0.030771658666753687, 1.0431732029005968e-18},
+    {0.0383188643021366, -2.357996157351286e-18},
+    {0.0458095360312942, 1.902959866474257e-18},
+    {0.053244514518812285, -1.665575816973663e-18},
+    {0.06062462181643484, 2.6424025938726934e-18},
+    {0.06795066190850775, -1.2802141240611733e-18},
+    {0.07522342123758753, -5.930604196293241e-18},
+    {0.08244366921107459, 5.700437773813987e-18},
+    {0.08961215868968714, -5.4268129336647135e-18},
+    {0.09672962645855111, -5.597397486289965e-19},
+    {0.10379679368164356, 5.47772415726659e-18},
+    {0.11081436634029011, 1.183748342825649e-18},
+    {0.11778303565638346, -1.1971685747593677e-18},
+    {0.12470347850095724, -4.6522609636496624e-18},
+    {0.13157635778871926, 1.1123000879729588e-17},
+    {0.13840232285911913, 4.447777301357527e-18},
+    {0.1451820098444979, 8.242418783022475e-18},
+    {0.15191604202584197, 6.4838631244022194e-18},
+    {0.15860503017663857, 1.1257003872182592e-17},
+    {0.16524957289530717, -1.0094935622322628e-17},
+    {0.17185025692665923, -6.0224538210113705e-18},
+    {0.1784076574728183, -1.2432553788701131e-17},
+    {0.184922338494012, 3.0236614153574064e-18},
+    {0.19139485299962947, -1.2129496905792884e-17},
+    {0.19782574332991987, 1.2821194372980142e-17},
+    {0.2042155414286909, 2.7338281018722773e-18},
+    {0.21056476910734964, -4.249405314729895e-18},
+    {0.21687393830061436, 4.551026193234283e-18},
+    {0.22314355131420976, -9.091270597324799e-18},
+    {0.22937410106484582, 9.927671823978025e-18},
+    {0.2355660713127669, -2.3943371495187355e-18},
+    {0.24171993688714516, 8.900990022166643e-18},
+    {0.24783616390458127, -1.2432209578702523e-17},
+    {0.25391520998096345, -8.048097394424201e-18},
+    {0.25995752443692605, 2.069806938978935e-17},
+    {0.26596354849713794, 5.3393802761314314e-18},
+    {0.27193371548364176, 7.83319637697442e-19},
+    {0.2778684510034563, -9.16018294909263e-19},
+    {0.2837681731306446, -2.032665581126656e-17},
+    {0.28963329258304266, 2.0535953219858174e-17},
+    {0.2954642128938359, -2.16461086040599e-17},
+    {0.3012613305781618, -9.048511144048564e-18},
+    {0.3070250352949119, -1.2319916200101964e-17},
+    {0.3127557100038969, -1.451808353098951e-17},
+    {0.3184537311185346, 2.7114779367326236e-17},
+    {0.324119468654212, -7.958214381893813e-18},
+    {0.329753286372468, 2.122020616196946e-18},
+    {0.3353555419211378, 1.834564437059473e-17},
+    {0.3409265869705932, 1.7467136443544747e-17},
+    {0.34646676734620857, 1.028583585496265e-17},
+    {0.3519764231571782, -1.2953893030191963e-17},
+    {0.3574558889218038, -2.5136910072413547e-17},
+    {0.3629054936893685, -2.1492361455310972e-17},
+    {0.3683255611587076, 2.690672380132659e-17},
+    {0.37371640979358406, 2.1836211281198184e-17},
+    {0.37907835293496944, 1.587939415338447e-17},
+    {0.38441169891033206, -1.612149700764673e-17},
+    {0.3897167511400252, 2.734172667856699e-17},
+    {0.394993808240869, -1.5113724418336168e-17},
+    {0.4002431641270127, -1.1349239205188711e-17},
+    {0.4054651081081644, -2.8811380259626426e-18}};
+
+// ln(2) split into three parts, where the first one has only 42 significant
+// bits, so its product with any exponent of a double is exact.
+static const double LN2_1 = 0.6931471805598903;
+static const double LN2_2 = 5.497923018708371e-14;
+static const double LN2_3 = 1.94704509238075e-31;
+
+/**
+ * Logarithm of m in [1/sqrt(2), sqrt(2)).
+ *
+ * Splits off c = 1 + k/128 between 1 and m, such that
+ *
+ *   log(m) = log(c) + 2 atanh(u),  u = (m - c)/(m + c),
+ *
+ * where abs(u) < 0.0055, so the series of atanh(u) converges to double-double
+ * precision after nine terms, of which only the first four need double-double
+ * arithmetic.  Since log(c) and atanh(u) have the same sign, there is no
+ * cancellation in the sum.
+ */
+static DDouble log_reduced(DDouble m)
+{
+    const DDouble third(0.3333333333333333, 1.850371707708594e-17);
+    const DDouble fifth(0.2, -1.1102230246251566e-17);
+    const DDouble seventh(0.14285714285714285, 7.93016446160826e-18);
+
+    double k = std::trunc(128.0 * (m.hi() - 1.0));
+    double c = 1.0 + k / 128.0;
+
+    // For k = 0, the error of u is not diluted by log(c), so we refine the
+    // quotient twice with exact residuals: m - c and the products are exact.
+    DDouble num = m - c, den = m + c;
+    double q1 = num.hi() / den.hi();
+    DDouble r = (num - ExDouble(q1) * den.hi()) - ExDouble(q1) * den.lo();
+    double q2 = r.hi() / den.hi();
+    r = (r - ExDouble(q2) * den.hi()) - ExDouble(q2) * den.lo();
+    double q3 = r.hi() / den.hi();
+    DDouble u = (ExDouble(q1) + q2).add_small(q3);
+    DDouble v = u * u;
+    double vd = v.hi();
+    double tail = 1.0 / 9 + vd * (1.0 / 11 + vd * (1.0 / 13 +
+                  vd * (1.0 / 15 + vd * (1.0 / 17))));
+    DDouble series = v * (third + v * (fifth + v * (seventh + vd * tail)));
+    DDouble atanh_u = u.add_small(u * series);
+    return LOG1P_128TH[int(k) + 64] + PowerOfTwo(2.0) * atanh_u;
+}
+
 XPREC_API_EXPORT
 DDouble log(DDouble x)
 {
-    // Start with logarithm of hi part
-    DDouble log_x = std::log(x.hi());
-    if (!isfinite(log_x))
-        return log_x;
-
-    // Abramowitz and Stegun give the following series expansion (4.1.30):
-    //
-    //   log(x) = log(x0) + 2 (x - x0)/(x + x0) + O(x - x0)^3
-    //
-    DDouble x0 = exp(log_x);
-    DDouble corr = PowerOfTwo(2.0) * (x - x0) / (x + x0);
-    log_x += corr;
-    return log_x;
+    // Handles zero, negative numbers, infinity and NaN
+    if (!(x.hi() > 0.0 && x.hi() < INFINITY))
+        return std::log(x.hi());
+
+    // x = 2^e m, where m in [1/sqrt(2), sqrt(2)); scaling is exact
+    int e;
+    double f = std::frexp(x.hi(), &e);
+    if (f < 0.7071067811865476)
+        --e;
+    DDouble m = ldexp(x, -e);
+    DDouble log_m = log_reduced(m);
+    if (e == 0)
+        return log_m;
+
+    // Since abs(e) < 2^11, the first two parts of e ln(2) are exact, and the
+    // sum of the small terms is accurate relative to the result.
+    DDouble small = ExDouble((double)e) * LN2_2;
+    small = small.add_small(e * LN2_3) + log_m;
+    return small + e * LN2_1;
 }
 
 XPREC_API_EXPORT
 DDouble log1p(DDouble x)
 {
-    // Start with logarithm of hi part
-    DDouble log_x = std::log1p(x.hi());
-    if (!isfinite(log_x))
-        return log_x;
-
-    // Again, we can use the same correction, but log1p <-> expm1
-    //
-    //   log(1 + x) = log(1 + x0) + 2 (x - x0)/(2 + x + x0) + O(x - x0)^3
-    //
-    // One need not worry about cancellation in the denominator for
-    // x close to -1, since that is where we have an intrinsic loss of
-    // precision anyway
-    DDouble x0 = expm1(log_x);
-    DDouble corr = PowerOfTwo(2.0) * (x - x0) / (2 + x + x0);
-    log_x += corr;
-    return log_x;
+    // Handles x <= -1, infinity and NaN
+    if (!(x.hi() > -1.0 && x.hi() < INFINITY))
+        return std::log1p(x.hi());
+
+    // Forming y = 1 + x rounds away the bits of x below the precision of
+    // y, which we add back as the first-order correction d/y, where d is
+    // the rounding error.
+    DDouble y = 1.0 + x;
+    double d = (x - (y - 1.0)).hi();
+    return log(y) + d / y.hi();
 }
 
 XPREC_API_EXPORT
@@ -360,4 +583,222 @@ DDouble pow(DDouble x, int n)
 XPREC_API_EXPORT
 DDouble pow(DDouble x, DDouble y) { return exp(log(x) * y); }
 
+// ---------------------------------------------------------------------------
+// Batched versions
+//
+// The scalar functions above branch on the argument and look up single table
+// entries.  The kernels below perform the same reductions for a full pack of
+// lanes at once: table lookups become gathers, and branches are replaced by
+// arithmetic blends.  Lanes outside the range of a kernel are recomputed by
+// apply_batch() using the scalar functions.
+
+template <int N>
+static DDoubleVec<N> expm1_kernel_taylor(DDoubleVec<N> x, int n)
+{
+    DDoubleVec<N> xpow = x * x;
+    DDoubleVec<N> r = x.add_small(PowerOfTwo(0.5) * xpow);
+    int k = 3;
+    for (; k <= n / 2 + 1; ++k) {
+        xpow *= x;
+        r = r.add_small(DDoubleVec<N>(reciprocal_factorial(k)) * xpow);
+    }
+
+    DoubleVec<N> xpow_d = xpow.hi();
+    DoubleVec<N> r_d = 0.0;
+    for (; k <= n; ++k) {
+        xpow_d = xpow_d * x.hi();
+        r_d = r_d + reciprocal_factorial(k).hi() * xpow_d;
+    }
+    return r.add_small(r_d);
+}
+
+template <int N>
+static DDoubleVec<N> exp_reduce(DDoubleVec<N> x, DoubleVec<N> &k)
+{
+    // See the scalar version.  n is rounded to even rather than away from
+    // zero, which only makes a difference for ties, where both are valid.
+    DoubleVec<N> n = rint_small(184.6649652337873 * x.hi());
+    DDoubleVec<N> r = (x - n * LN2_128TH_1) - ExDoubleVec<N>(n) * LN2_128TH_2;
+    r = r.add_small(-n * LN2_128TH_3);
+
+    // The fractional part of (n + 64)/128 is a multiple of 1/128, so shifting
+    // it by 127/256 and rounding to nearest gives the floor.
+    k = rint_small((n + 64.0) / 128.0 - 0.49609375);
+    DoubleVec<N> j = n - 128.0 * k;
+
+    DDoubleVec<N> t = DDoubleVec<N>::gather(EXP2M1_128TH, j + 64.0);
+    DDoubleVec<N> expm1_r = expm1_kernel_taylor(r, 10);
+    return t + expm1_r * ExDoubleVec<N>(1.0).add_small(t);
+}
+
+template <int N>
+static DDoubleVec<N> exp_kernel(DDoubleVec<N> x)
+{
+    // Valid for abs(x) < 708.  The clamp keeps the reduction in bounds
+    // for all other lanes (including NaN, as max() then returns -708).
+    DoubleVec<N> x_hi = min(max(x.hi(), -708.0), 708.0);
+    x = DDoubleVec<N>(x_hi, x.lo());
+
+    // Here, abs(k) <= 1021, so 2^k is a normal number
+    DoubleVec<N> k;
+    DDoubleVec<N> s = exp_reduce(x, k);
+    return ldexp(ExDoubleVec<N>(1.0).add_small(s), k);
+}
+
+template <int N>
+static DDoubleVec<N> expm1_kernel(DDoubleVec<N> x)
+{
+    // Valid for abs(x) < 708, see exp_kernel().
+    DoubleVec<N> x_hi = min(max(x.hi(), -708.0), 708.0);
+    x = DDoubleVec<N>(x_hi, x.lo());
+
+    DoubleVec<N> k;
+    DDoubleVec<N> s = exp_reduce(x, k);
+    DDoubleVec<N> exp_x = ldexp(ExDoubleVec<N>(1.0).add_small(s), k);
+
+    // For k = 0, we need to use s directly to avoid cancellation.
+    DoubleVec<N> is_scaled = min(max(k, -k), 1.0);
+    return choose(is_scaled, s, exp_x - 1.0);
+}
+
+template <int N>
+static DDoubleVec<N> log_reduced(DDoubleVec<N> m)
+{
+    // See the scalar version
+    const DDouble third(0.3333333333333333, 1.850371707708594e-17);
+    const DDouble fifth(0.2, -1.1102230246251566e-17);
+    const DDouble seventh(0.14285714285714285, 7.93016446160826e-18);
+
+    DoubleVec<N> k = trunc_small(128.0 * (m.hi() - 1.0));
+    DoubleVec<N> c = 1.0 + k / 128.0;
+
+    DDoubleVec<N> num = m - c, den = m + c;
+    DoubleVec<N> q1 = num.hi() / den.hi();
+    DDoubleVec<N> r = (num - ExDoubleVec<N>(q1) * den.hi()) -
+                      ExDoubleVec<N>(q1) * den.lo();
+    DoubleVec<N> q2 = r.hi() / den.hi();
+    r = (r - ExDoubleVec<N>(q2) * den.hi()) - ExDoubleVec<N>(q2) * den.lo();
+    DoubleVec<N> q3 = r.hi() / den.hi();
+    DDoubleVec<N> u = (ExDoubleVec<N>(q1) + q2).add_small(q3);
+    DDoubleVec<N> v = u * u;
+    DoubleVec<N> vd = v.hi();
+    DoubleVec<N> tail = 1.0 / 9 + vd * (1.0 / 11 + vd * (1.0 / 13 +
+                        vd * (1.0 / 15 + vd * (1.0 / 17))));
+    DDoubleVec<N> series =
+        v * (DDoubleVec<N>(third) +
+             v * (DDoubleVec<N>(fifth) + v * (DDoubleVec<N>(seventh) +
+                                              vd * tail)));
+    DDoubleVec<N> atanh_u = u.add_small(u * series);
+    return DDoubleVec<N>::gather(LOG1P_128TH, k + 64.0) +
+           PowerOfTwo(2.0) * atanh_u;
+}
+
+template <int N>
+static DDoubleVec<N> log_kernel(DDoubleVec<N> x)
+{
+    // Valid for 1e-300 <= x <= 1e300.  The clamp keeps the exponent
+    // extraction and the table lookup in bounds for all other lanes.
+    DoubleVec<N> x_hi = min(max(x.hi(), 1e-300), 1e300);
+    x = DDoubleVec<N>(x_hi, x.lo());
+
+    // x = 2^e m, where m in [1/sqrt(2), sqrt(2)) up to the round-off in the
+    // product, which log_reduced() tolerates; scaling is exact.
+    DoubleVec<N> e = logb(x.hi() * 1.4142135623730951);
+    DDoubleVec<N> m = ldexp(x, -e);
+    DDoubleVec<N> log_m = log_reduced(m);
+
+    // See the scalar version.  For e = 0, this reduces to log_m.
+    DDoubleVec<N> small = ExDoubleVec<N>(e) * LN2_2;
+    small = small.add_small(e * LN2_3) + log_m;
+    return small + e * LN2_1;
+}
+
+template <int N>
+static DDoubleVec<N> log1p_kernel(DDoubleVec<N> x)
+{
+    // Valid for -1 < x <= 1e300, see the scalar version
+    DDoubleVec<N> y = 1.0 + x;
+    DoubleVec<N> d = (x - (y - 1.0)).hi();
+    return log_kernel(y) + d / y.hi();
+}
+
+struct ExpBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const { return exp_kernel(x); }
+    DDouble operator()(DDouble x) const { return exp(x); }
+    bool special(DDouble x) const { return !(std::fabs(x.hi()) < 708.0); }
+};
+
+struct Expm1Batch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const
+    {
+        return expm1_kernel(x);
+    }
+    DDouble operator()(DDouble x) const { return expm1(x); }
+    bool special(DDouble x) const { return !(std::fabs(x.hi()) < 708.0); }
+};
+
+struct LogBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const { return log_kernel(x); }
+    DDouble operator()(DDouble x) const { return log(x); }
+    bool special(DDouble x) const
+    {
+        return !(x.hi() >= 1e-300 && x.hi() <= 1e300);
+    }
+};
+
+struct Log1pBatch {
+    template <int N>
+    DDoubleVec<N> operator()(DDoubleVec<N> x) const
+    {
+        return log1p_kernel(x);
+    }
+    DDouble operator()(DDouble x) const { return log1p(x); }
+    bool special(DDouble x) const
+    {
+        return !(x.hi() > -1.0 && x.hi() <= 1e300);
+    }
+};
+
+XPREC_API_EXPORT
+void exp(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, ExpBatch());
+}
+
+XPREC_API_EXPORT
+void expm1(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, Expm1Batch());
+}
+
+XPREC_API_EXPORT
+void log(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, LogBatch());
+}
+
+XPREC_API_EXPORT
+void log1p(const DDouble *x, DDouble *y, size_t n)
+{
+    apply_batch<XPREC_BATCH_WIDTH>(x, y, n, Log1pBatch());
+}
+
+XPREC_API_EXPORT
+void pow(const DDouble *x, const DDouble *y, DDouble *z, size_t n)
+{
+    // Work in chunks, such that z may alias x or y.
+    const size_t chunk = 256;
+    DDouble tmp[chunk];
+    for (size_t i = 0; i < n; i += chunk) {
+        size_t m = std::min(chunk, n - i);
+        log(x + i, tmp, m);
+        for (size_t j = 0; j != m; ++j)
+            tmp[j] *= y[i + j];
+        exp(tmp, z + i, m);
+    }
+}
+
 } // namespace xprec
@@ -0,0 +1,11 @@
+/* Export macros for functions of the compiled library.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+
+// In header-only mode, XPREC_API_EXPORT is already defined to inline.
+#ifndef XPREC_API_EXPORT
+#define XPREC_API_EXPORT
+#endif
@@ -1,16 +1,18 @@
-/* Gauss-Legendre quadrature
+/* Gaussian quadrature
  *
  * Copyright (C) 2023 Markus Wallerberger and others
  * SPDX-License-Identifier: MIT
  */
+#include "batch.h"
+#include "export.h"
+#include "parallel.h"
 #include "xprec/ddouble.h"
 #include "xprec/internal/utils.h"
 #include "xprec/numbers.h"
+#include <algorithm>
 #include <cassert>
-
-#ifndef XPREC_API_EXPORT
-#define XPREC_API_EXPORT
-#endif
+#include <cmath>
+#include <vector>
 
 namespace xprec {
 
@@ -26,6 +28,10 @@ void gauss_chebyshev(int n, DDouble x[], DDouble w[])
         if (w != nullptr)
             w[i] = fact;
     }
+    // cos(pi/2) is not exactly zero, but the middle node should be, so that
+    // rules of different odd sizes share it (see smolyak_rule()).
+    if (n % 2 == 1)
+        x[n / 2] = 0.0;
 }
 
 static void leg_deriv(int N, DDouble x, DDouble &Pn, DDouble &dPn)
@@ -51,40 +57,801 @@ static void leg_deriv(int N, DDouble x, DDouble &Pn, DDouble &dPn)
     }
 }
 
+// -------------------------------------------------------------------------
+// Asymptotic construction of Gauss-Legendre rules for large n
+//
+// For large n, evaluating P_n by the recurrence makes the construction of the
+// rule O(n^2).  Instead, we follow Hale and Townsend [^1]: we work with the
+// angles theta = arccos(x) of the nodes and evaluate P_n(cos theta) with
+// Stieltjes' expansion [^2], which costs O(1) per node.  The expansion does not
+// converge close to the end points, but this only affects a fixed number of
+// nodes, for which we fall back to the recurrence.  This makes the total cost
+// O(n).
+//
+// [^1]: N. Hale and A. Townsend, SIAM J. Sci. Comput. 35, A652 (2013)
+// [^2]: G. Szego, Orthogonal Polynomials, 4th ed., AMS (1975), eq. (8.21.14)
+
+/** Smallest order for which gauss_legendre uses the asymptotic construction */
+static const int GAUSS_ASY_MIN_N = 100;
+
+/**
+ * Stieltjes' expansion is used for nodes where 2 n sin(theta) exceeds this:
+ * the terms then drop below u^2 before the series starts to diverge.
+ */
+static const double GAUSS_ASY_MIN_X = 80.0;
+
+/**
+ * Maximum number of nodes close to each end point which need the recurrence:
+ * 2 n sin(theta) < GAUSS_ASY_MIN_X holds for at most 13 of them.
+ */
+static const int GAUSS_ASY_MAX_EDGE = 16;
+
+/**
+ * Evaluate f = P_n(cos theta) and its derivative df = dP_n/dtheta by the
+ * recurrence for m angles theta close to zero.
+ *
+ * This is O(n), but stays accurate close to x = 1, where cos(theta) loses
+ * the relative accuracy of theta: the recurrence is rewritten in terms of
+ * y = 1 - cos(theta) and the differences D_k = P_k - P_{k-1}, which are small
+ * there.  All angles are processed at once in packs of N, which shares the
+ * coefficients of the recurrence and makes use of SIMD instructions.
+ */
+template <int N>
+static void leg_deriv_edge(int n, int m, const DDouble theta[], DDouble f[],
+                           DDouble df[])
+{
+    assert(n >= 1);
+    assert(m <= GAUSS_ASY_MAX_EDGE);
+
+    DDouble buf[GAUSS_ASY_MAX_EDGE];
+    for (int i = 0; i != GAUSS_ASY_MAX_EDGE; ++i) {
+        DDouble sin_half = i < m ? sin(0.5 * theta[i]) : DDouble(0.0);
+        buf[i] = 2.0 * sin_half * sin_half;
+    }
+
+    // P and its derivative with respect to y, and the same for D
+    const int packs = (m + N - 1) / N;
+    DDoubleVec<N> y[GAUSS_ASY_MAX_EDGE / N], P[GAUSS_ASY_MAX_EDGE / N],
+        dP[GAUSS_ASY_MAX_EDGE / N], D[GAUSS_ASY_MAX_EDGE / N],
+        dD[GAUSS_ASY_MAX_EDGE / N];
+    for (int j = 0; j != packs; ++j) {
+        y[j] = DDoubleVec<N>::load(buf + j * N);
+        P[j] = 1.0 - y[j];
+        dP[j] = DDouble(-1.0);
+        D[j] = -y[j];
+        dD[j] = DDouble(-1.0);
+    }
+    for (int k = 1; k < n; ++k) {
+        // D_{k+1} = (k D_k - (2k + 1) y P_k) / (k + 1), from Bonnet's formula
+        DDouble inv = reciprocal(ExDouble(k + 1.0));
+        DDoubleVec<N> a = 1.0 - inv;
+        DDoubleVec<N> b = 2.0 - inv;
+        for (int j = 0; j != packs; ++j) {
+            DDoubleVec<N> D_next = a * D[j] - b * (y[j] * P[j]);
+            dD[j] = a * dD[j] - b * (P[j] + y[j] * dP[j]);
+            D[j] = D_next;
+            P[j] += D[j];
+            dP[j] += dD[j];
+        }
+    }
+
+    for (int j = 0; j != packs; ++j)
+        P[j].store(buf + j * N);
+    for (int i = 0; i != m; ++i)
+        f[i] = buf[i];
+
+    for (int j = 0; j != packs; ++j)
+        dP[j].store(buf + j * N);
+    for (int i = 0; i != m; ++i)
+        df[i] = sin(theta[i]) * buf[i];
+}
+
+/**
+ * Evaluate f = P_n(cos theta) / C_n and its derivative df = df/dtheta by
+ * Stieltjes' expansion, where 2 n sin(theta) must exceed GAUSS_ASY_MIN_X.
+ *
+ * P_n(cos theta) = C_n sum_m h_m cos(a_m) / (2 sin theta)^(m + 1/2), where
+ * a_m = (n + m + 1/2) theta - (m + 1/2) pi/2 and the h_m are given by a simple
+ * recurrence.  We get the cos(a_m) by successive rotations from a_0.
+ */
+static void leg_stieltjes(int n, DDouble theta, DDouble &f, DDouble &df)
+{
+    DDouble s, c, sin_a, cos_a;
+    sincos(theta, s, c);
+    sincos((n + 0.5) * theta - numbers::pi_4, sin_a, cos_a);
+
+    DDouble inv_2s = 0.5 / s;
+    DDouble two_c_inv_2s = 2.0 * c * inv_2s;
+    DDouble scale = sqrt(inv_2s);
+    DDouble h = 1.0;
+    DDouble scale0 = scale;
+    f = 0.0;
+    df = 0.0;
+    for (int m = 0; m < 1000; ++m) {
+        DDouble term = h * scale;
+        f += term * cos_a;
+        df -= term * ((n + m + 0.5) * sin_a + (m + 0.5) * two_c_inv_2s * cos_a);
+        if (term.hi() < 1e-33 * scale0.hi())
+            break;
+
+        // Advance from a_m to a_{m+1} = a_m + theta - pi/2
+        DDouble cos_next = cos_a * s + sin_a * c;
+        sin_a = sin_a * s - cos_a * c;
+        cos_a = cos_next;
+
+        h *= ExDouble((m + 0.5) * (m + 0.5)) / ((m + 1.0) * (n + m + 1.5));
+        scale *= inv_2s;
+    }
+}
+
+/**
+ * Bernoulli numbers B_2, B_4, ..., B_34 as numerator and denominator, which
+ * are both exactly representable.
+ */
+static const double gauss_bernoulli[17][2] = {
+    {1, 6},
+    {-1, 30},
+    {1, 42},
+    {-1, 30},
+    {5, 66},
+    {-691, 2730},
+    {7, 6},
+    {-3617, 510},
+    {43867, 798},
+    {-174611, 330},
+    {854513, 138},
+    {-236364091, 2730},
+    {8553103, 6},
+    {-23749461029.0, 870},
+    {8615841276005.0, 14322},
+    {-7709321041217.0, 510},
+    {2577687858367.0, 6}};
+
+/**
+ * Compute the constant C_n = 2/sqrt(pi) Gamma(n + 1) / Gamma(n + 3/2) in
+ * front of Stieltjes' expansion for n >= 100.
+ *
+ * We use the asymptotic series log(Gamma(n + 1) / Gamma(n + 1/2)) =
+ * log(n)/2 + sum_k c_k / n^k over odd k, where c_k = B_{k+1}(2 - 2^-k) /
+ * (k (k + 1)), in terms of the Bernoulli numbers B_j.
+ */
+static DDouble leg_stieltjes_constant(int n)
+{
+    assert(n >= 100);
+    DDouble inv_n = reciprocal(ExDouble(n));
+    DDouble inv_n2 = inv_n * inv_n;
+    DDouble series = 0.0;
+    for (int j = 9; j >= 0; --j) {
+        int k = 2 * j + 1;
+        DDouble c_k = ExDouble(gauss_bernoulli[j][0]) / gauss_bernoulli[j][1];
+        c_k = c_k * (2.0 - std::ldexp(1.0, -k)) / (k * (k + 1.0));
+        series = series * inv_n2 + c_k;
+    }
+    series *= inv_n;
+    return 2.0 * numbers::inv_sqrtpi * sqrt(DDouble(n)) * exp(series) /
+           (n + 0.5);
+}
+
+/**
+ * Refine the root theta of some function by Newton's method, where
+ * eval(theta, f, df) computes the function and its derivative.  Returns the
+ * derivative at the root.
+ */
+template <typename Eval>
+static DDouble gauss_newton_theta(Eval eval, DDouble &theta)
+{
+    DDouble f, df;
+    for (int iter = 0; iter < 20; ++iter) {
+        eval(theta, f, df);
+        DDouble dtheta = f / df;
+        theta -= dtheta;
+        if (std::fabs(dtheta.hi()) <= 1e-18 * theta.hi())
+            break;
+    }
+
+    // The iteration converges quadratically, so after one more step, theta
+    // is accurate to double-double precision.  The derivative for the
+    // weight is also taken from this step.
+    eval(theta, f, df);
+    theta -= f / df;
+    return df;
+}
+
+/** McMahon's expansion of the k-th zero of the Bessel function J_0 */
+static double bessel_j0_zero(int k)
+{
+    static const double first[3] = {2.404825557695773, 5.520078110286311,
+                                    8.653727912911013};
+    if (k <= 3)
+        return first[k - 1];
+
+    double beta = (k - 0.25) * numbers::pi.hi();
+    double inv_b2 = 1.0 / (beta * beta);
+    return beta + (0.125 + (-31.0 / 384 + 3779.0 / 15360 * inv_b2) * inv_b2) /
+                      beta;
+}
+
+/** Number of nodes per task when refining the nodes on several threads */
+static const int GAUSS_TASK_NODES = 256;
+
+/**
+ * Compute nodes k0, ..., k1 - 1, counted from the right starting at 1, of the
+ * rule of order n >= GAUSS_ASY_MIN_N, runs on worker threads.
+ *
+ * The initial guess is Tricomi's approximation, which we refine using
+ * Stieltjes' expansion.  Also stores the mirrored nodes.
+ */
+static void gauss_legendre_bulk(int n, int k0, int k1, DDouble C_n,
+                                DDouble x[], DDouble w[])
+{
+    const double pi = numbers::pi.hi();
+    auto stieltjes = [n](DDouble theta, DDouble &f, DDouble &df) {
+        leg_stieltjes(n, theta, f, df);
+    };
+    for (int k = k0; k < k1; ++k) {
+        double phi = (4 * k - 1) * pi / (4 * n + 2);
+        double corr = 1 - (1 - 1.0 / n) / (8.0 * n * n);
+        DDouble theta = std::acos(corr * std::cos(phi));
+        DDouble df = gauss_newton_theta(stieltjes, theta) * C_n;
+
+        x[n - k] = cos(theta);
+        x[k - 1] = -x[n - k];
+        if (w != nullptr)
+            w[n - k] = w[k - 1] = 2.0 / (df * df);
+    }
+}
+
+/** Gauss-Legendre rule of order n >= GAUSS_ASY_MIN_N in O(n) */
+static void gauss_legendre_asy(int n, DDouble x[], DDouble w[])
+{
+    assert(n >= GAUSS_ASY_MIN_N);
+
+    // The k-th node from the right is the (n - k)-th element, its mirror
+    // image the (k - 1)-th.  First find the nodes close to the end points.
+    const double pi = numbers::pi.hi();
+    const double rho = n + 0.5;
+    int n_edge = 0;
+    while (2 * n * std::sin((n_edge + 0.75) * pi / rho) < GAUSS_ASY_MIN_X)
+        ++n_edge;
+    assert(n_edge <= GAUSS_ASY_MAX_EDGE);
+
+    // Gatteschi's approximation in terms of Bessel zeros for those, which
+    // we refine by Newton iteration for all of them at once.
+    DDouble theta[GAUSS_ASY_MAX_EDGE], f[GAUSS_ASY_MAX_EDGE],
+        df[GAUSS_ASY_MAX_EDGE];
+    for (int i = 0; i != n_edge; ++i) {
+        double psi = bessel_j0_zero(i + 1) / rho;
+        theta[i] = psi + (psi / std::tan(psi) - 1) / (8 * psi * rho * rho);
+    }
+    for (int iter = 0; iter < 20; ++iter) {
+        leg_deriv_edge<XPREC_BATCH_WIDTH>(n, n_edge, theta, f, df);
+        double max_rel = 0;
+        for (int i = 0; i != n_edge; ++i) {
+            DDouble dtheta = f[i] / df[i];
+            theta[i] -= dtheta;
+            max_rel = std::max(max_rel, std::fabs(dtheta.hi() / theta[i].hi()));
+        }
+        if (max_rel <= 1e-18)
+            break;
+    }
+    leg_deriv_edge<XPREC_BATCH_WIDTH>(n, n_edge, theta, f, df);
+    for (int i = 0; i != n_edge; ++i) {
+        theta[i] -= f[i] / df[i];
+        x[n - 1 - i] = cos(theta[i]);
+        x[i] = -x[n - 1 - i];
+        if (w != nullptr)
+            w[n - 1 - i] = w[i] = 2.0 / (df[i] * df[i]);
+    }
+
+    // The others are independent, so we distribute them over threads.
+    DDouble C_n = leg_stieltjes_constant(n);
+    const int k_first = n_edge + 1;
+    const int k_last = n / 2;
+    const size_t tasks = (k_last - n_edge + GAUSS_TASK_NODES - 1) /
+                         GAUSS_TASK_NODES;
+    parallel_for(tasks, max_threads(), [&](size_t t) {
+        int k0 = k_first + t * GAUSS_TASK_NODES;
+        int k1 = std::min(k0 + GAUSS_TASK_NODES, k_last + 1);
+        gauss_legendre_bulk(n, k0, k1, C_n, x, w);
+    });
+
+    // Middle node for odd n
+    if (n % 2 == 1) {
+        DDouble f, df;
+        leg_stieltjes(n, numbers::pi_half, f, df);
+        x[n / 2] = 0.0;
+        if (w != nullptr)
+            w[n / 2] = 2.0 / (C_n * df * C_n * df);
+    }
+}
+
+/**
+ * Refine i-th node of the rule of order n by Newton iteration and compute the
+ * corresponding weight.
+ *
+ * Each node is iterated until it has converged on its own, since the nodes
+ * close to the end points usually take more iterations.
+ */
+static void gauss_legendre_node(int n, int i, DDouble x[], DDouble w[])
+{
+    DDouble Pn, dPn;
+    for (int iter = 0; iter < 10; ++iter) {
+        leg_deriv(n, x[i], Pn, dPn);
+        DDouble dx = -Pn / dPn;
+        x[i] += dx;
+        if (_internal::greater_in_magnitude(2.5e-32, dx))
+            break;
+    }
+
+    // Weight from the derivative of the last step
+    if (w != nullptr)
+        w[i] = 2.0 / ((1.0 - x[i] * x[i]) * dPn * dPn);
+}
+
 XPREC_API_EXPORT
 void gauss_legendre(int n, DDouble x[], DDouble w[])
 {
     if (n < 1)
         return;
+    if (n >= GAUSS_ASY_MIN_N) {
+        gauss_legendre_asy(n, x, w);
+        return;
+    }
 
-    // Initial guess for x: Gauss-Chebyshev nodes
+    // Initial guess for x: Gauss-Chebyshev nodes.  By symmetry, we only need
+    // to refine the non-negative half of the nodes, starting at i = n/2.
     gauss_chebyshev(n, x);
+    // This takes at most a few milliseconds below GAUSS_ASY_MIN_N, so we do
+    // not bother with threads.
+    const int half = n / 2;
+    for (int i = half; i < n; ++i)
+        gauss_legendre_node(n, i, x, w);
 
-    // Perform Newton iteration to refine x
-    // store derivatives in w for later use
-    for (int iter = 0; iter < 10; ++iter) {
-        bool converged = true;
-        for (int i = 0; i < n; ++i) {
-            DDouble Pn, dPn, dx;
-            leg_deriv(n, x[i], Pn, dPn);
-            dx = -Pn / dPn;
-            x[i] += dx;
-            if (w != nullptr)
-                w[i] = dPn;
-
-            if (converged && !_internal::greater_in_magnitude(2.5e-32, dx))
-                converged = false;
+    for (int i = half; i < n; ++i) {
+        x[n - 1 - i] = -x[i];
+        if (w != nullptr)
+            w[n - 1 - i] = w[i];
+    }
+    if (n % 2 == 1)
+        x[half] = 0.0;
+}
+
+/**
+ * Stirling's series for log(Gamma(x)), x > 0.
+ *
+ * Shifts the argument to z = x + m >= 20, where the series has converged to
+ * double-double precision after 17 terms, and returns the Pochhammer symbol
+ * (x)_m, such that Gamma(x) = Gamma(z) / (x)_m, alongside z.  The return
+ * value is log(Gamma(z)) - (z - 1/2) log(z) + z - log(2 pi) / 2.
+ */
+static DDouble gauss_stirling(DDouble x, DDouble &z, DDouble &pochhammer)
+{
+    pochhammer = 1.0;
+    z = x;
+    for (; z < 20.0; z += 1.0)
+        pochhammer *= z;
+
+    DDouble inv_z = reciprocal(z);
+    DDouble inv_z2 = inv_z * inv_z;
+    DDouble series = 0.0;
+    for (int j = 16; j >= 0; --j) {
+        int k = 2 * j + 2;
+        DDouble c_k = ExDouble(gauss_bernoulli[j][0]) / gauss_bernoulli[j][1];
+        series = series * inv_z2 + c_k / (k * (k - 1.0));
+    }
+    return series * inv_z;
+}
+
+/**
+ * Logarithm of the Gamma function for x > 0.
+ *
+ * The result is accurate in absolute rather than relative terms, so its
+ * exponential has a relative error proportional to log(Gamma(x)).
+ */
+static DDouble gauss_lgamma(DDouble x)
+{
+    assert(x > 0.0);
+
+    DDouble z, pochhammer;
+    DDouble series = gauss_stirling(x, z, pochhammer);
+    return (z - 0.5) * log(z) - z + 0.5 * log(2.0 * numbers::pi) + series -
+           log(pochhammer);
+}
+
+/**
+ * Gamma function for x > 0.
+ *
+ * Uses Stirling's series, see gauss_stirling().  Since log(Gamma(z)) is
+ * large, we do not exponentiate it as a whole, but split off the integer
+ * power of z in z^(z - 1/2), which is computed by repeated squaring.  Above
+ * x = 170, where Gamma(x) is about to overflow, gauss_lgamma() is used.
+ */
+static DDouble gauss_gamma(DDouble x)
+{
+    assert(x > 0.0);
+
+    // Integers and half-integers, which are the most common cases, are
+    // computed directly from Gamma(1) = 1 and Gamma(1/2) = sqrt(pi).
+    DDouble twice = 2.0 * x;
+    if (twice.lo() == 0.0 && twice.hi() == std::floor(twice.hi()) &&
+        twice.hi() <= 60.0) {
+        bool half = std::fmod(twice.hi(), 2.0) != 0.0;
+        DDouble gamma = half ? numbers::pi * numbers::inv_sqrtpi : DDouble(1.0);
+        for (double z = half ? 0.5 : 1.0; z < x.hi(); z += 1.0)
+            gamma *= z;
+        return gamma;
+    }
+    if (x >= 170.0)
+        return exp(gauss_lgamma(x));
+
+    DDouble z, pochhammer;
+    DDouble series = gauss_stirling(x, z, pochhammer);
+
+    // Gamma(z) = sqrt(2 pi) z^(z - 1/2) exp(-z + series).  z^m alone
+    // overflows for z above about 143, so multiply in its two halves on
+    // either side of the exponential, which is at least exp(-170).
+    DDouble power = z - 0.5;
+    int m = (int)std::floor(power.hi());
+    DDouble frac = power - m;
+    DDouble gamma_z = sqrt(2.0 * numbers::pi) * pow(z, m / 2) *
+                      exp(frac * log(z) - z + series);
+    gamma_z *= pow(z, m - m / 2);
+    return gamma_z / pochhammer;
+}
+
+/**
+ * Eigenvalues of the symmetric tridiagonal matrix with diagonal d[0 .. n-1]
+ * and off-diagonal e[1 .. n-1] (e[0] is ignored), in double precision.
+ *
+ * Uses the implicit QL algorithm with Wilkinson shifts, which takes O(n^2)
+ * time.  Overwrites d with the eigenvalues in ascending order and destroys e.
+ */
+static void gauss_tridiag_eigenvalues(int n, double d[], double e[])
+{
+    for (int i = 1; i < n; ++i)
+        e[i - 1] = e[i];
+    e[n - 1] = 0.0;
+
+    for (int l = 0; l < n; ++l) {
+        for (int iter = 0; iter < 60; ++iter) {
+            int m = l;
+            for (; m < n - 1; ++m) {
+                double dd = std::fabs(d[m]) + std::fabs(d[m + 1]);
+                if (std::fabs(e[m]) <= 1e-17 * dd)
+                    break;
+            }
+            if (m == l)
+                break;
+
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i = m - 1;
+            for (; i >= l; --i) {
+                double f = s * e[i];
+                double b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0.0) {
+                    // Underflow: matrix splits, restart this eigenvalue
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+            }
+            if (i >= l)
+                continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
         }
-        if (converged)
+    }
+    std::sort(d, d + n);
+}
+
+/**
+ * Jacobi matrix of a family of orthonormal polynomials p_k, which obey the
+ * three-term recurrence:
+ *
+ *     x p_k(x) = b[k+1] p_{k+1}(x) + a[k] p_k(x) + b[k] p_{k-1}(x),
+ *
+ * with p_0 = 1/sqrt(mu0), where mu0 is the integral of the weight function.
+ * a and b have n elements, where b[0] = 0.
+ */
+struct GaussRecurrence {
+    std::vector<DDouble> a, b;
+    DDouble mu0;
+
+    explicit GaussRecurrence(int n) : a(n, 0.0), b(n, 0.0), mu0(1.0) { }
+};
+
+/**
+ * Evaluate the polynomial q(x) = (x - a[n-1]) p_{n-1}(x) - b[n-1] p_{n-2}(x),
+ * whose zeros are the eigenvalues of the Jacobi matrix, its derivative dq
+ * and the Christoffel sum s = sum_k p_k(x)^2 for k < n, where we set p_0 = 1.
+ *
+ * To avoid overflow far outside the support of the weight, all quantities
+ * are scaled by 2^(-scale) and s by 2^(-2 * scale).
+ */
+static void gauss_recurrence_eval(const GaussRecurrence &rec,
+                                  const DDouble inv_b[], DDouble x,
+                                  DDouble &q, DDouble &dq, DDouble &s,
+                                  int &scale)
+{
+    const int n = rec.a.size();
+    DDouble p_prev = 0.0, p = 1.0, dp_prev = 0.0, dp = 0.0;
+    s = 1.0;
+    scale = 0;
+    for (int k = 0; k < n - 1; ++k) {
+        DDouble x_a = x - rec.a[k];
+        DDouble p_next = (x_a * p - rec.b[k] * p_prev) * inv_b[k + 1];
+        DDouble dp_next = (x_a * dp + p - rec.b[k] * dp_prev) * inv_b[k + 1];
+        p_prev = p;
+        p = p_next;
+        dp_prev = dp;
+        dp = dp_next;
+        s += p * p;
+
+        if (std::fabs(p.hi()) > 1e90 || std::fabs(dp.hi()) > 1e90) {
+            const PowerOfTwo down = std::ldexp(1.0, -300);
+            p *= down;
+            p_prev *= down;
+            dp *= down;
+            dp_prev *= down;
+            s *= down * down;
+            scale += 300;
+        }
+    }
+    DDouble x_a = x - rec.a[n - 1];
+    q = x_a * p - rec.b[n - 1] * p_prev;
+    dq = x_a * dp + p - rec.b[n - 1] * dp_prev;
+}
+
+/**
+ * Refine i-th node of a Gauss rule from the Jacobi matrix by Newton iteration
+ * and compute the corresponding weight, runs on worker threads.  If fixed is
+ * true, the node is a prescribed end point of a Radau or Lobatto rule and
+ * stays put.
+ */
+static void gauss_recurrence_node(const GaussRecurrence &rec,
+                                  const DDouble inv_b[], double x_min,
+                                  bool fixed, DDouble &x, DDouble *w)
+{
+    DDouble q, dq, s;
+    int scale;
+    for (int iter = 0; iter < 10 && !fixed; ++iter) {
+        gauss_recurrence_eval(rec, inv_b, x, q, dq, s, scale);
+        DDouble dx = -q / dq;
+        x += dx;
+        double tol = 1e-17 * std::max(std::fabs(x.hi()), x_min);
+        if (_internal::greater_in_magnitude(tol, dx))
             break;
     }
 
-    // Compute weights if so desired
+    // Christoffel number at the final node, where we also take a last Newton
+    // step, which is too small to affect the weight.
     if (w != nullptr) {
-        for (int i = 0; i < n; ++i) {
-            w[i] = 2.0 / ((1.0 - x[i] * x[i]) * w[i] * w[i]);
-        }
+        gauss_recurrence_eval(rec, inv_b, x, q, dq, s, scale);
+        *w = ldexp(rec.mu0 / s, -2 * scale);
+        if (!fixed)
+            x -= q / dq;
+    }
+}
+
+/**
+ * Orders from which gauss_from_recurrence refines the nodes on several
+ * threads.  The refinement takes O(n^2) time, which is about 12 ms for n = 128
+ * on one core, so starting the threads is amortized from here on.
+ */
+static const int GAUSS_REC_PARALLEL_MIN_N = 128;
+
+/**
+ * Compute Gauss rule from the Jacobi matrix.
+ *
+ * Instead of diagonalizing the Jacobi matrix in double-double precision, which
+ * would take O(n^3) time, we find its eigenvalues in double precision
+ * (Golub-Welsch) and polish each one by Newton iteration on the recurrence.
+ * The weights are then computed from the Christoffel numbers. Overall, this
+ * takes O(n^2) time.  The nfixed prescribed nodes in fixed are kept exactly.
+ */
+static void gauss_from_recurrence(const GaussRecurrence &rec, int nfixed,
+                                  const double fixed[], DDouble x[],
+                                  DDouble w[])
+{
+    const int n = rec.a.size();
+    std::vector<double> d(n), e(n);
+    std::vector<DDouble> inv_b(n);
+    for (int k = 0; k < n; ++k) {
+        d[k] = rec.a[k].hi();
+        e[k] = rec.b[k].hi();
+        inv_b[k] = k == 0 ? DDouble(0.0) : reciprocal(rec.b[k]);
+    }
+    gauss_tridiag_eigenvalues(n, d.data(), e.data());
+
+    // Newton converges quadratically from the double-precision guesses, so
+    // we stop once the relative correction is at the level of double
+    // precision.  Nodes close to zero are refined to an absolute accuracy.
+    double norm = std::max(std::fabs(d[0]), std::fabs(d[n - 1]));
+    double x_min = std::max(1e-15 * norm, 1e-300);
+
+    // Prescribed nodes are end points and thus the extremal eigenvalues
+    std::vector<char> is_fixed(n, 0);
+    for (int j = 0; j < nfixed; ++j) {
+        int i = fixed[j] < 0 ? 0 : n - 1;
+        d[i] = fixed[j];
+        is_fixed[i] = 1;
+    }
+
+    unsigned nthreads = n < GAUSS_REC_PARALLEL_MIN_N ? 1 : max_threads();
+    parallel_for(n, nthreads, [&](size_t i) {
+        x[i] = d[i];
+        gauss_recurrence_node(rec, inv_b.data(), x_min, is_fixed[i], x[i],
+                              w != nullptr ? &w[i] : nullptr);
+    });
+}
+
+/**
+ * Modify the last row of the Jacobi matrix for n >= 2 such that z1 and z2
+ * are zeros of the new q(x), i.e., are nodes of the Gauss-Lobatto rule
+ * (Golub, 1973).  If only_z1 is true, only a[n-1] is modified such that z1 is
+ * a zero, which yields a Gauss-Radau rule.
+ */
+static void gauss_modify_recurrence(GaussRecurrence &rec, double z1, double z2,
+                                    bool only_z1)
+{
+    // Ratio r(z) = pi_{n-1}(z) / pi_{n-2}(z) of monic polynomials, which does
+    // not overflow for z outside of the support of the weight.
+    const int n = rec.a.size();
+    auto ratio = [&](DDouble z) {
+        DDouble r = z - rec.a[0];
+        for (int k = 1; k < n - 1; ++k)
+            r = (z - rec.a[k]) - rec.b[k] * rec.b[k] / r;
+        return r;
+    };
+
+    DDouble r1 = ratio(z1);
+    if (only_z1) {
+        DDouble b2 = rec.b[n - 1] * rec.b[n - 1];
+        rec.a[n - 1] = z1 - b2 / r1;
+        return;
+    }
+    DDouble r2 = ratio(z2);
+    DDouble a = (z1 * r1 - z2 * r2) / (r1 - r2);
+    rec.a[n - 1] = a;
+    rec.b[n - 1] = sqrt(r1 * (z1 - a));
+}
+
+/** Jacobi matrix of the Jacobi polynomials P_k^(alpha, beta) */
+static GaussRecurrence gauss_jacobi_recurrence(int n, double alpha,
+                                               double beta)
+{
+    assert(alpha > -1 && beta > -1);
+    GaussRecurrence rec(n);
+    const DDouble ab = ExDouble(alpha) + beta;
+    const DDouble diff = ExDouble(beta) - alpha;
+
+    // First row separately, since the general formulas are 0/0 there for
+    // alpha + beta = 0 or -1.
+    rec.a[0] = diff / (ab + 2.0);
+    if (n > 1) {
+        rec.b[1] = sqrt(4.0 * (1.0 + ExDouble(alpha)) * (1.0 + ExDouble(beta)) /
+                        ((ab + 2.0) * (ab + 2.0) * (ab + 3.0)));
+    }
+    for (int k = 1; k < n; ++k) {
+        DDouble two_k_ab = 2.0 * k + ab;
+        rec.a[k] = diff * ab / (two_k_ab * (two_k_ab + 2.0));
+        if (k == 1)
+            continue;
+        DDouble num = 4.0 * k * (ExDouble(alpha) + (double)k) *
+                      (ExDouble(beta) + (double)k) * (k + ab);
+        DDouble den = two_k_ab * two_k_ab * (two_k_ab + 1.0) *
+                      (two_k_ab - 1.0);
+        rec.b[k] = sqrt(num / den);
+    }
+
+    // mu0 = 2^(alpha + beta + 1) B(alpha + 1, beta + 1).  Once the Gamma
+    // function in the denominator overflows, switch to log B, which costs
+    // a relative error proportional to log Gamma(alpha + beta + 2).
+    if (ab + 2.0 < 170.0) {
+        rec.mu0 = pow(DDouble(2.0), ab + 1.0) * gauss_gamma(alpha + 1.0) *
+                  gauss_gamma(beta + 1.0) / gauss_gamma(ab + 2.0);
+    } else {
+        rec.mu0 = exp((ab + 1.0) * numbers::ln2 + gauss_lgamma(alpha + 1.0) +
+                      gauss_lgamma(beta + 1.0) - gauss_lgamma(ab + 2.0));
+    }
+    return rec;
+}
+
+XPREC_API_EXPORT
+void gauss_jacobi(int n, double alpha, double beta, DDouble x[], DDouble w[])
+{
+    if (n < 1)
+        return;
+    GaussRecurrence rec = gauss_jacobi_recurrence(n, alpha, beta);
+    gauss_from_recurrence(rec, 0, nullptr, x, w);
+}
+
+XPREC_API_EXPORT
+void gauss_jacobi_radau(int n, double alpha, double beta, DDouble x[],
+                        DDouble w[])
+{
+    if (n < 1)
+        return;
+    GaussRecurrence rec = gauss_jacobi_recurrence(n, alpha, beta);
+    if (n == 1) {
+        x[0] = -1.0;
+        if (w != nullptr)
+            w[0] = rec.mu0;
+        return;
+    }
+    const double fixed[] = {-1.0};
+    gauss_modify_recurrence(rec, -1.0, 0.0, true);
+    gauss_from_recurrence(rec, 1, fixed, x, w);
+}
+
+XPREC_API_EXPORT
+void gauss_jacobi_lobatto(int n, double alpha, double beta, DDouble x[],
+                          DDouble w[])
+{
+    if (n < 1)
+        return;
+    if (n == 1) {
+        // There is no rule with both end points as nodes
+        x[0] = NAN;
+        if (w != nullptr)
+            w[0] = NAN;
+        return;
+    }
+    GaussRecurrence rec = gauss_jacobi_recurrence(n, alpha, beta);
+    const double fixed[] = {-1.0, 1.0};
+    gauss_modify_recurrence(rec, -1.0, 1.0, false);
+    gauss_from_recurrence(rec, 2, fixed, x, w);
+}
+
+XPREC_API_EXPORT
+void gauss_laguerre(int n, double alpha, DDouble x[], DDouble w[])
+{
+    assert(alpha > -1);
+    if (n < 1)
+        return;
+    GaussRecurrence rec(n);
+    for (int k = 0; k < n; ++k) {
+        rec.a[k] = 2.0 * k + 1.0 + ExDouble(alpha);
+        rec.b[k] = sqrt(k * (ExDouble(alpha) + (double)k));
+    }
+    rec.mu0 = gauss_gamma(alpha + 1.0);
+    gauss_from_recurrence(rec, 0, nullptr, x, w);
+}
+
+XPREC_API_EXPORT
+void gauss_hermite(int n, DDouble x[], DDouble w[])
+{
+    if (n < 1)
+        return;
+    GaussRecurrence rec(n);
+    for (int k = 0; k < n; ++k) {
+        rec.a[k] = 0.0;
+        rec.b[k] = sqrt(DDouble(0.5 * k));
+    }
+    rec.mu0 = numbers::pi * numbers::inv_sqrtpi;
+    gauss_from_recurrence(rec, 0, nullptr, x, w);
+
+    // Enforce symmetry of the rule
+    for (int i = 0; i < n / 2; ++i) {
+        x[i] = -x[n - 1 - i];
+        if (w != nullptr)
+            w[i] = w[n - 1 - i];
     }
+    if (n % 2 == 1)
+        x[n / 2] = 0.0;
 }
 
 } /* namespace xprec */
@@ -3,14 +3,11 @@
  * Copyright (C) 2023 Markus Wallerberger and others
  * SPDX-License-Identifier: MIT
  */
+#include "export.h"
 #include "taylor.h"
 #include "xprec/ddouble.h"
 #include "xprec/internal/utils.h"
 
-#ifndef XPREC_API_EXPORT
-#define XPREC_API_EXPORT
-#endif
-
 namespace xprec {
 
 XPREC_API_EXPORT
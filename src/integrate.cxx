@@ -0,0 +1,365 @@
+/* Adaptive Gauss-Kronrod integration.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "parallel.h"
+#include "xprec/ddouble.h"
+#include "xprec/integrate.h"
+#include "xprec/internal/utils.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+namespace xprec {
+
+/**
+ * Integral of the product of three Legendre polynomials over [-1, 1]
+ * (Adams-Neumann), where A[m] = binom(2m, m) / 4^m.
+ */
+static DDouble kronrod_triple(const std::vector<DDouble> &A, int a, int b,
+                              int c)
+{
+    if ((a + b + c) % 2 != 0 || a > b + c || b > a + c || c > a + b)
+        return 0.0;
+    int s = (a + b + c) / 2;
+    return 2.0 * A[s - a] * A[s - b] * A[s - c] / ((2.0 * s + 1.0) * A[s]);
+}
+
+/**
+ * Evaluate the Stieltjes polynomial E(x) = sum_j e[j] P_j(x) of degree n + 1
+ * and its derivative.
+ */
+static void kronrod_stieltjes(const std::vector<DDouble> &e, DDouble x,
+                              DDouble &E, DDouble &dE)
+{
+    DDouble P_1 = 0.0, P = 1.0, dP_1 = 0.0, dP = 0.0;
+    E = e[0];
+    dE = 0.0;
+    for (int k = 0; k + 1 < (int)e.size(); ++k) {
+        // (k + 1) P_{k+1} = (2k + 1) x P_k - k P_{k-1}
+        DDouble P_next = ((2.0 * k + 1.0) * x * P - 1.0 * k * P_1) / (k + 1.0);
+        DDouble dP_next = ((2.0 * k + 1.0) * (x * dP + P) - 1.0 * k * dP_1) /
+                          (k + 1.0);
+        P_1 = P;
+        P = P_next;
+        dP_1 = dP;
+        dP = dP_next;
+        E += e[k + 1] * P;
+        dE += e[k + 1] * dP;
+    }
+}
+
+XPREC_API_EXPORT
+GaussKronrodRule::GaussKronrodRule(int n)
+    : _n(n)
+    , _x(2 * n + 1)
+    , _w(2 * n + 1)
+    , _gauss_w(n)
+{
+    assert(n >= 1);
+    std::vector<DDouble> gauss_x(n);
+    gauss_legendre(n, gauss_x.data(), _gauss_w.data());
+
+    // The Stieltjes polynomial E, whose zeros are the new nodes, is orthogonal
+    // to all polynomials of degree <= n with respect to the weight P_n(x).
+    // Expanding E in Legendre polynomials with e[n+1] = 1, the orthogonality
+    // to P_k for odd k = 1, 3, ... fixes e[n-k] in turn.
+    std::vector<DDouble> A((3 * n + 1) / 2 + 2);
+    A[0] = 1.0;
+    for (size_t m = 1; m < A.size(); ++m)
+        A[m] = A[m - 1] * (2.0 * m - 1.0) / (2.0 * m);
+
+    std::vector<DDouble> e(n + 2, 0.0);
+    e[n + 1] = 1.0;
+    for (int k = 1; k <= n; k += 2) {
+        DDouble sum = 0.0;
+        for (int j = n - k + 2; j <= n + 1; j += 2)
+            sum += e[j] * kronrod_triple(A, n, j, k);
+        e[n - k] = -sum / kronrod_triple(A, n, n - k, k);
+    }
+
+    // The new nodes interlace with the Gauss nodes, so we can safeguard
+    // Newton's method by bisection.  By symmetry, we only need the
+    // non-negative half.
+    for (int i = n / 2; i <= n; ++i) {
+        DDouble lo = i == 0 ? DDouble(-1.0) : gauss_x[i - 1];
+        DDouble hi = i == n ? DDouble(1.0) : gauss_x[i];
+        DDouble E, dE, E_lo, dE_lo;
+        kronrod_stieltjes(e, lo, E_lo, dE_lo);
+
+        DDouble x = 0.5 * (lo + hi);
+        if (n % 2 == 0 && i == n / 2)
+            x = 0.0;
+        for (int iter = 0; iter < 100; ++iter) {
+            kronrod_stieltjes(e, x, E, dE);
+            if ((E < 0.0) == (E_lo < 0.0))
+                lo = x;
+            else
+                hi = x;
+
+            DDouble x_new = x - E / dE;
+            if (!(x_new > lo && x_new < hi))
+                x_new = 0.5 * (lo + hi);
+            DDouble dx = x_new - x;
+            x = x_new;
+            if (_internal::greater_in_magnitude(2.5e-32, dx))
+                break;
+        }
+        _x[2 * i] = x;
+    }
+    for (int i = 0; i < n; ++i)
+        _x[2 * i + 1] = gauss_x[i];
+    for (int i = 0; i < n; ++i)
+        _x[i] = -_x[2 * n - i];
+    if (n % 2 == 0)
+        _x[n] = 0.0;
+
+    // Kronrod weights are the integrals of the Lagrange polynomials, which
+    // have degree 2n and are thus integrated exactly by Gauss-Legendre with
+    // n + 1 nodes.
+    const int m = n + 1;
+    std::vector<DDouble> X(m), W(m);
+    gauss_legendre(m, X.data(), W.data());
+    for (int i = 0; i <= n; ++i) {
+        DDouble denom = 1.0;
+        for (int j = 0; j <= 2 * n; ++j) {
+            if (j != i)
+                denom *= _x[i] - _x[j];
+        }
+        DDouble sum = 0.0;
+        for (int q = 0; q < m; ++q) {
+            DDouble l = W[q];
+            for (int j = 0; j <= 2 * n; ++j) {
+                if (j != i)
+                    l *= X[q] - _x[j];
+            }
+            sum += l;
+        }
+        _w[i] = sum / denom;
+        _w[2 * n - i] = _w[i];
+    }
+}
+
+/**
+ * Subinterval with its Kronrod result, error estimate and Kronrod result for
+ * the integral of abs(f)
+ */
+struct KronrodInterval {
+    DDouble a, b, value, error, magnitude;
+
+    bool operator<(const KronrodInterval &other) const
+    {
+        return error < other.error;
+    }
+};
+
+/**
+ * Number of intervals evaluated with one call to the integrand, which should
+ * be large enough to amortize the overhead of the call.
+ */
+static const size_t KRONROD_TASK_INTERVALS = 8;
+
+/** Maximum number of intervals bisected in one round */
+static const size_t KRONROD_MAX_SPLIT = 256;
+
+/**
+ * Evaluate Kronrod and Gauss rule on count intervals with one call of f,
+ * runs on worker threads.
+ */
+static void kronrod_evaluate(const GaussKronrodRule &rule,
+                             const BatchIntegrand &f, KronrodInterval iv[],
+                             size_t count)
+{
+    const size_t size = rule.size();
+    std::vector<DDouble> x(count * size), fx(count * size);
+    for (size_t i = 0; i != count; ++i) {
+        DDouble center = 0.5 * (iv[i].a + iv[i].b);
+        DDouble half = 0.5 * (iv[i].b - iv[i].a);
+        for (size_t k = 0; k != size; ++k)
+            x[i * size + k] = center + half * rule.x()[k];
+    }
+    f(x.data(), fx.data(), x.size());
+
+    for (size_t i = 0; i != count; ++i) {
+        const DDouble *fi = &fx[i * size];
+        DDouble kronrod = 0.0, gauss = 0.0, magnitude = 0.0;
+        for (size_t k = 0; k != size; ++k) {
+            kronrod += rule.w()[k] * fi[k];
+            magnitude += rule.w()[k] * abs(fi[k]);
+        }
+        for (int k = 0; k != rule.order(); ++k)
+            gauss += rule.gauss_w()[k] * fi[2 * k + 1];
+
+        DDouble half = 0.5 * (iv[i].b - iv[i].a);
+        iv[i].value = half * kronrod;
+        iv[i].error = abs(half * (kronrod - gauss));
+        iv[i].magnitude = abs(half) * magnitude;
+        if (isnan(iv[i].error))
+            iv[i].error = std::numeric_limits<DDouble>::infinity();
+    }
+}
+
+/** Evaluate intervals on up to nthreads threads */
+static void kronrod_evaluate_all(const GaussKronrodRule &rule,
+                                 const BatchIntegrand &f,
+                                 std::vector<KronrodInterval> &iv,
+                                 unsigned nthreads)
+{
+    size_t tasks = (iv.size() + KRONROD_TASK_INTERVALS - 1) /
+                   KRONROD_TASK_INTERVALS;
+    parallel_for(tasks, nthreads, [&](size_t t) {
+        size_t begin = t * KRONROD_TASK_INTERVALS;
+        size_t count = std::min(KRONROD_TASK_INTERVALS, iv.size() - begin);
+        kronrod_evaluate(rule, f, &iv[begin], count);
+    });
+}
+
+/** Sum up values, errors and magnitudes of all intervals */
+static void kronrod_sum(const std::vector<KronrodInterval> &iv,
+                        DDouble &value, DDouble &error, DDouble &magnitude)
+{
+    value = 0.0;
+    error = 0.0;
+    magnitude = 0.0;
+    for (const KronrodInterval &ivi : iv) {
+        value += ivi.value;
+        error += ivi.error;
+        magnitude += ivi.magnitude;
+    }
+}
+
+/**
+ * Multiple of epsilon times the integral of abs(f), below which the error
+ * estimate is dominated by round-off and cannot be reduced by bisection.
+ */
+static const double INTEGRATE_ROUNDOFF = 16.0;
+
+XPREC_API_EXPORT
+IntegrateResult integrate(const BatchIntegrand &f, DDouble a, DDouble b,
+                          DDouble tol, const IntegrateOptions &options)
+{
+    assert(options.order >= 1);
+    assert(options.max_intervals >= 1);
+    const GaussKronrodRule rule(options.order);
+    const unsigned nthreads =
+        options.threads != 0 ? options.threads : max_threads();
+
+    IntegrateResult result;
+    result.ok = false;
+    result.evaluations = 0;
+
+    std::vector<KronrodInterval> fresh(1);
+    fresh[0].a = a;
+    fresh[0].b = b;
+    kronrod_evaluate_all(rule, f, fresh, nthreads);
+    result.evaluations += rule.size();
+
+    // Max-heap of intervals ordered by error, as in std::priority_queue, but
+    // we need to iterate over it for summing up
+    std::vector<KronrodInterval> queue(1, fresh[0]);
+    DDouble value = fresh[0].value;
+    DDouble error = fresh[0].error;
+    DDouble magnitude = fresh[0].magnitude;
+    const DDouble eps = std::numeric_limits<DDouble>::epsilon();
+
+    std::vector<KronrodInterval> split;
+    for (;;) {
+        DDouble target = fmax(tol * abs(value), options.abs_tol);
+        target = fmax(target, INTEGRATE_ROUNDOFF * eps * magnitude);
+        if (error <= target) {
+            result.ok = true;
+            break;
+        }
+        if (queue.size() >= options.max_intervals)
+            break;
+
+        // Bisect the intervals with the largest errors, until removing
+        // their error would reach the target.  This does not depend on the
+        // number of threads.
+        size_t max_split = std::min(KRONROD_MAX_SPLIT,
+                                    options.max_intervals - queue.size());
+        DDouble remaining = error;
+        split.clear();
+        while (!queue.empty() && split.size() < max_split) {
+            std::pop_heap(queue.begin(), queue.end());
+            split.push_back(queue.back());
+            queue.pop_back();
+
+            // Intervals with infinite error come first: split only those,
+            // since the remaining error is unknown until we sum up anew.
+            if (!isfinite(split.back().error)) {
+                if (queue.empty() || isfinite(queue.front().error))
+                    break;
+                continue;
+            }
+            remaining -= split.back().error;
+            if (remaining <= target)
+                break;
+        }
+
+        fresh.resize(2 * split.size());
+        bool stuck = false;
+        for (size_t i = 0; i != split.size(); ++i) {
+            DDouble mid = 0.5 * (split[i].a + split[i].b);
+            if (!(mid > fmin(split[i].a, split[i].b) &&
+                  mid < fmax(split[i].a, split[i].b)))
+                stuck = true;
+            fresh[2 * i].a = split[i].a;
+            fresh[2 * i].b = mid;
+            fresh[2 * i + 1].a = mid;
+            fresh[2 * i + 1].b = split[i].b;
+        }
+        if (stuck) {
+            // Interval cannot be bisected any further in double-double
+            for (const KronrodInterval &iv : split) {
+                queue.push_back(iv);
+                std::push_heap(queue.begin(), queue.end());
+            }
+            break;
+        }
+
+        kronrod_evaluate_all(rule, f, fresh, nthreads);
+        result.evaluations += fresh.size() * rule.size();
+        bool resum = false;
+        for (const KronrodInterval &iv : split) {
+            value -= iv.value;
+            error -= iv.error;
+            magnitude -= iv.magnitude;
+            resum |= !isfinite(iv.magnitude) || !isfinite(iv.error);
+        }
+        for (const KronrodInterval &iv : fresh) {
+            value += iv.value;
+            error += iv.error;
+            magnitude += iv.magnitude;
+            queue.push_back(iv);
+            std::push_heap(queue.begin(), queue.end());
+        }
+
+        // If a node hits a singularity, the error of its interval is
+        // infinite, which turns the running sums into NaN once it is split.
+        if (resum)
+            kronrod_sum(queue, value, error, magnitude);
+    }
+
+    // Sum up anew to get rid of the cancellation in the running sums
+    result.intervals = queue.size();
+    kronrod_sum(queue, result.value, result.error, magnitude);
+    return result;
+}
+
+XPREC_API_EXPORT
+IntegrateResult integrate(const std::function<DDouble(DDouble)> &f, DDouble a,
+                          DDouble b, DDouble tol,
+                          const IntegrateOptions &options)
+{
+    BatchIntegrand batch = [&f](const DDouble *x, DDouble *fx, size_t n) {
+        for (size_t i = 0; i != n; ++i)
+            fx[i] = f(x[i]);
+    };
+    return integrate(batch, a, b, tol, options);
+}
+
+} /* namespace xprec */
@@ -0,0 +1,226 @@
+/* Linear systems by mixed-precision iterative refinement.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/blas.h"
+#include "xprec/ddouble.h"
+#include "xprec/linalg.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace xprec {
+
+/**
+ * LU decomposition with partial pivoting of the n x n matrix f in place.
+ *
+ * Row k was swapped with row piv[k] >= k in step k, as in LAPACK's getrf.
+ * The loops are ordered such that the innermost loop runs down a column,
+ * which is contiguous and can be vectorized.  Returns false if f is singular.
+ */
+static bool lu_factor(size_t n, double *f, size_t *piv)
+{
+    for (size_t k = 0; k < n; ++k) {
+        double *fk = f + k * n;
+        size_t p = k;
+        for (size_t i = k + 1; i < n; ++i) {
+            if (std::fabs(fk[i]) > std::fabs(fk[p]))
+                p = i;
+        }
+        if (!(std::fabs(fk[p]) > 0))
+            return false;
+
+        piv[k] = p;
+        if (p != k) {
+            double *a = f + k, *b = f + p;
+            for (size_t j = 0; j < n; ++j)
+                std::swap(a[j * n], b[j * n]);
+        }
+
+        const double inv_pivot = 1.0 / fk[k];
+        for (size_t i = k + 1; i < n; ++i)
+            fk[i] *= inv_pivot;
+
+        for (size_t j = k + 1; j < n; ++j) {
+            double *fj = f + j * n;
+            const double t = fj[k];
+            if (t == 0)
+                continue;
+            for (size_t i = k + 1; i < n; ++i)
+                fj[i] -= fk[i] * t;
+        }
+    }
+    return true;
+}
+
+/**
+ * Cholesky decomposition A = L L^T of the n x n matrix f in place.
+ *
+ * Only the lower triangle is referenced and overwritten by L.  Returns false
+ * if f is not positive definite.
+ */
+static bool cholesky_factor(size_t n, double *f)
+{
+    for (size_t j = 0; j != n; ++j) {
+        double *fj = f + j * n;
+        for (size_t k = 0; k != j; ++k) {
+            const double *fk = f + k * n;
+            const double t = fk[j];
+            for (size_t i = j; i != n; ++i)
+                fj[i] -= fk[i] * t;
+        }
+        if (!(fj[j] > 0))
+            return false;
+
+        const double diag = std::sqrt(fj[j]);
+        fj[j] = diag;
+        for (size_t i = j + 1; i != n; ++i)
+            fj[i] /= diag;
+    }
+    return true;
+}
+
+/** Solve A y = r in place using the LU decomposition from lu_factor() */
+static void lu_apply(size_t n, const double *f, const size_t *piv, double *y)
+{
+    for (size_t k = 0; k != n; ++k)
+        std::swap(y[k], y[piv[k]]);
+
+    for (size_t k = 0; k != n; ++k) {
+        const double *fk = f + k * n;
+        for (size_t i = k + 1; i != n; ++i)
+            y[i] -= fk[i] * y[k];
+    }
+    for (size_t k = n; k-- != 0;) {
+        const double *fk = f + k * n;
+        y[k] /= fk[k];
+        for (size_t i = 0; i != k; ++i)
+            y[i] -= fk[i] * y[k];
+    }
+}
+
+/** Solve A y = r in place using the Cholesky factor from cholesky_factor() */
+static void cholesky_apply(size_t n, const double *f, double *y)
+{
+    for (size_t k = 0; k != n; ++k) {
+        const double *fk = f + k * n;
+        y[k] /= fk[k];
+        for (size_t i = k + 1; i != n; ++i)
+            y[i] -= fk[i] * y[k];
+    }
+    for (size_t k = n; k-- != 0;) {
+        const double *fk = f + k * n;
+        double t = y[k];
+        for (size_t i = k + 1; i != n; ++i)
+            t -= fk[i] * y[i];
+        y[k] = t / fk[k];
+    }
+}
+
+XPREC_API_EXPORT
+RefinedSolver::RefinedSolver(size_t n, const DDouble *a, size_t lda,
+                             Method method)
+    : _n(n)
+    , _method(method)
+    , _ok(false)
+    , _norm(0.0)
+    , _a(n * n)
+    , _f(n * n)
+    , _piv(n)
+{
+    assert(lda >= std::max<size_t>(n, 1));
+
+    for (size_t j = 0; j != n; ++j) {
+        for (size_t i = 0; i != n; ++i) {
+            // For Cholesky, mirror the lower triangle to get the full matrix
+            // for the residual.
+            bool upper = method == CHOLESKY && i < j;
+            _a[i + j * n] = upper ? a[j + i * lda] : a[i + j * lda];
+            _f[i + j * n] = _a[i + j * n].hi();
+        }
+    }
+
+    // Infinity norm of A, which sets the scale for the residual
+    for (size_t i = 0; i != n; ++i) {
+        double row_sum = 0.0;
+        for (size_t j = 0; j != n; ++j)
+            row_sum += std::fabs(_f[i + j * n]);
+        _norm = std::max(_norm, row_sum);
+    }
+
+    if (method == CHOLESKY)
+        _ok = cholesky_factor(n, _f.data());
+    else
+        _ok = lu_factor(n, _f.data(), _piv.data());
+}
+
+XPREC_API_EXPORT
+int RefinedSolver::solve(const DDouble *b, DDouble *x, int max_steps) const
+{
+    const size_t n = _n;
+    if (!_ok) {
+        std::fill(x, x + n, DDouble(std::numeric_limits<double>::quiet_NaN()));
+        return -1;
+    }
+
+    // A residual below this bound is at the level of the round-off error of
+    // computing it, so x is as good as the residual allows.
+    const double eps = std::ldexp(1.0, -104);
+    const double tol = (n + 1) * eps * _norm;
+
+    std::vector<DDouble> r(n);
+    std::vector<double> d(n);
+    std::fill(x, x + n, DDouble(0.0));
+    double prev_dnorm = std::numeric_limits<double>::infinity();
+
+    for (int step = 0; step != max_steps; ++step) {
+        std::copy(b, b + n, r.begin());
+        gemv(n, n, -1.0, _a.data(), std::max<size_t>(n, 1), x, 1.0, r.data());
+
+        double rnorm = 0.0, xnorm = 0.0;
+        for (size_t i = 0; i != n; ++i) {
+            rnorm = std::max(rnorm, std::fabs(r[i].hi()));
+            xnorm = std::max(xnorm, std::fabs(x[i].hi()));
+        }
+        if (rnorm <= tol * xnorm)
+            return step;
+
+        // The correction only needs to be accurate to double precision
+        for (size_t i = 0; i != n; ++i)
+            d[i] = r[i].hi();
+        if (_method == CHOLESKY)
+            cholesky_apply(n, _f.data(), d.data());
+        else
+            lu_apply(n, _f.data(), _piv.data(), d.data());
+
+        double dnorm = 0.0;
+        xnorm = 0.0;
+        for (size_t i = 0; i != n; ++i) {
+            x[i] += d[i];
+            dnorm = std::max(dnorm, std::fabs(d[i]));
+            xnorm = std::max(xnorm, std::fabs(x[i].hi()));
+        }
+        if (dnorm <= eps * xnorm)
+            return step + 1;
+
+        // Stop if the refinement fails to gain at least a bit per step: then
+        // A is too ill-conditioned, or the input is not finite.
+        if (!(dnorm <= 0.5 * prev_dnorm))
+            return -1;
+        prev_dnorm = dnorm;
+    }
+    return -1;
+}
+
+XPREC_API_EXPORT
+int solve(size_t n, const DDouble *a, size_t lda, const DDouble *b,
+          DDouble *x)
+{
+    return RefinedSolver(n, a, lda).solve(b, x);
+}
+
+} /* namespace xprec */
@@ -0,0 +1,94 @@
+/* Simple thread parallelism for the compiled library.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xprec {
+
+/**
+ * Maximum number of threads to use for parallel work.
+ *
+ * This is taken from the XPREC_NUM_THREADS environment variable if set, and
+ * otherwise is the number of hardware threads.
+ */
+inline unsigned max_threads()
+{
+    const char *env = std::getenv("XPREC_NUM_THREADS");
+    if (env != nullptr) {
+        int n = std::atoi(env);
+        if (n > 0)
+            return n;
+    }
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+/** True on threads which currently execute a parallel_for() task */
+inline bool &in_parallel_region()
+{
+    static thread_local bool inside = false;
+    return inside;
+}
+
+/**
+ * Call fn(i) for i = 0, ..., n-1 using up to nthreads threads.
+ *
+ * The tasks are handed out dynamically, so fn(i) may run on any thread and
+ * in any order.  fn must thus only write to memory private to task i.
+ *
+ * Calls nested inside a task run serially on the calling thread, so they do
+ * not multiply the number of threads.  If fn throws, the remaining tasks are
+ * skipped, and the first exception is rethrown once all threads have joined.
+ */
+template <typename Fn>
+void parallel_for(size_t n, unsigned nthreads, Fn fn)
+{
+    if (nthreads > n)
+        nthreads = n;
+    if (nthreads <= 1 || in_parallel_region()) {
+        for (size_t i = 0; i != n; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        bool &inside = in_parallel_region();
+        inside = true;
+        try {
+            for (size_t i = next++; i < n; i = next++)
+                fn(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+            next = n;
+        }
+        inside = false;
+    };
+    std::vector<std::thread> pool;
+    try {
+        for (unsigned t = 1; t != nthreads; ++t)
+            pool.emplace_back(worker);
+    } catch (...) {
+        // Could not start all threads: make do with the ones we have
+    }
+    worker();
+    for (std::thread &t : pool)
+        t.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} /* namespace xprec */
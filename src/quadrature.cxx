@@ -0,0 +1,234 @@
+/* Registry of quadrature rules.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/ddouble.h"
+#include "xprec/quadrature.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <utility>
+
+namespace xprec {
+
+XPREC_API_EXPORT
+QuadratureRule::QuadratureRule(std::vector<DDouble> x, std::vector<DDouble> w)
+    : _x(std::move(x))
+    , _w(std::move(w))
+{
+    assert(_x.size() == _w.size());
+}
+
+/** Entry of the cache, which is immutable once published */
+struct QuadratureCache::Entry {
+    Family family;
+    int n;
+    std::shared_ptr<const QuadratureRule> rule;
+};
+
+/** Rule which is being computed by some thread */
+struct QuadratureCache::Pending {
+    Family family;
+    int n;
+    std::shared_future<std::shared_ptr<const QuadratureRule>> rule;
+};
+
+XPREC_API_EXPORT
+QuadratureCache::QuadratureCache(size_t max_bytes, size_t max_rules)
+    : _max_bytes(max_bytes)
+    , _max_rules(max_rules)
+    , _rules(0)
+    , _bytes(0)
+{
+    // Open addressing with linear probing, where the table is at most half
+    // full.  Since entries are never removed, a probe sequence that hits an
+    // empty slot proves that the key is not present.
+    size_t capacity = 2;
+    while (capacity < 2 * max_rules)
+        capacity *= 2;
+    _mask = capacity - 1;
+    _slots.reset(new std::atomic<const Entry *>[capacity]);
+    for (size_t i = 0; i != capacity; ++i)
+        _slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+XPREC_API_EXPORT
+QuadratureCache::~QuadratureCache()
+{
+    for (size_t i = 0; i <= _mask; ++i)
+        delete _slots[i].load(std::memory_order_relaxed);
+}
+
+static size_t quadrature_hash(int family, int n)
+{
+    uint64_t key = (uint64_t)(uint32_t)n << 8 | (uint32_t)family;
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+XPREC_API_EXPORT
+const QuadratureCache::Entry *QuadratureCache::find(Family family, int n) const
+{
+    for (size_t i = quadrature_hash(family, n);; ++i) {
+        const Entry *entry = _slots[i & _mask].load(std::memory_order_acquire);
+        if (entry == nullptr)
+            return nullptr;
+        if (entry->family == family && entry->n == n)
+            return entry;
+    }
+}
+
+XPREC_API_EXPORT
+std::shared_ptr<const QuadratureRule> QuadratureCache::get(Family family, int n)
+{
+    if (n < 1)
+        return nullptr;
+
+    // Fast path: lock-free lookup
+    const Entry *entry = find(family, n);
+    if (entry != nullptr)
+        return entry->rule;
+
+    // Either wait for a thread which is already computing the rule, or
+    // announce that we are computing it ourselves.
+    std::shared_ptr<Pending> pending;
+    std::promise<std::shared_ptr<const QuadratureRule>> promise;
+    {
+        std::lock_guard<std::mutex> lock(_insert_mutex);
+        entry = find(family, n);
+        if (entry != nullptr)
+            return entry->rule;
+        for (size_t i = 0; i != _pending.size(); ++i) {
+            if (_pending[i]->family == family && _pending[i]->n == n)
+                pending = _pending[i];
+        }
+        if (pending == nullptr) {
+            _pending.push_back(std::make_shared<Pending>(
+                Pending{family, n, promise.get_future().share()}));
+        }
+    }
+    if (pending != nullptr)
+        return pending->rule.get();
+
+    // Compute the rule outside the lock, such that threads asking for
+    // different rules do not wait for each other.
+    std::shared_ptr<const QuadratureRule> rule;
+    try {
+        rule = make_rule(family, n);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(_insert_mutex);
+        remove_pending(family, n);
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_insert_mutex);
+        remove_pending(family, n);
+        if (_rules.load() < _max_rules &&
+            _bytes.load() + rule->bytes() <= _max_bytes) {
+            size_t i = quadrature_hash(family, n);
+            while (_slots[i & _mask].load(std::memory_order_relaxed) != nullptr)
+                ++i;
+            _slots[i & _mask].store(new Entry{family, n, rule},
+                                    std::memory_order_release);
+            _rules += 1;
+            _bytes += rule->bytes();
+        }
+    }
+    promise.set_value(rule);
+    return rule;
+}
+
+XPREC_API_EXPORT
+void QuadratureCache::remove_pending(Family family, int n)
+{
+    for (size_t i = 0; i != _pending.size(); ++i) {
+        if (_pending[i]->family == family && _pending[i]->n == n) {
+            _pending.erase(_pending.begin() + i);
+            return;
+        }
+    }
+}
+
+XPREC_API_EXPORT
+QuadratureCache &QuadratureCache::global()
+{
+    static QuadratureCache instance;
+    return instance;
+}
+
+XPREC_API_EXPORT
+std::shared_ptr<const QuadratureRule> make_rule(QuadratureCache::Family family,
+                                                int n)
+{
+    if (n < 1)
+        return nullptr;
+    std::vector<DDouble> x(n), w(n);
+    switch (family) {
+    case QuadratureCache::GAUSS_CHEBYSHEV:
+        gauss_chebyshev(n, x.data(), w.data());
+        break;
+    case QuadratureCache::GAUSS_LEGENDRE:
+        gauss_legendre(n, x.data(), w.data());
+        break;
+    }
+    return std::make_shared<const QuadratureRule>(std::move(x), std::move(w));
+}
+
+XPREC_API_EXPORT
+std::shared_ptr<const QuadratureRule> gauss_legendre_rule(int n)
+{
+    return QuadratureCache::global().get(QuadratureCache::GAUSS_LEGENDRE, n);
+}
+
+XPREC_API_EXPORT
+std::shared_ptr<const QuadratureRule> gauss_chebyshev_rule(int n)
+{
+    return QuadratureCache::global().get(QuadratureCache::GAUSS_CHEBYSHEV, n);
+}
+
+XPREC_API_EXPORT
+CompositeRule::CompositeRule(const DDouble *edges, size_t nedges, int order)
+    : _order(order)
+    , _offsets(std::max(nedges, size_t(1)))
+{
+    assert(order >= 1);
+    const size_t nseg = segments();
+    const size_t n = nseg * order;
+    _x.resize(n);
+    _w.resize(n);
+    _x_minus_a.resize(n);
+    _b_minus_x.resize(n);
+
+    // Distances 1 + t and 1 - t of the reference nodes to the edges of
+    // [-1, 1], where the latter follow from the former by symmetry.
+    std::shared_ptr<const QuadratureRule> ref = gauss_legendre_rule(order);
+    std::vector<DDouble> t_lo(order), t_hi(order);
+    for (int i = 0; i < order; ++i) {
+        t_lo[i] = 1.0 + ref->x()[i];
+        t_hi[order - 1 - i] = t_lo[i];
+    }
+
+    for (size_t s = 0; s < nseg; ++s) {
+        const DDouble a = edges[s], b = edges[s + 1];
+        assert(a <= b);
+        const DDouble half = 0.5 * (b - a);
+        const size_t base = s * order;
+        _offsets[s] = base;
+        for (int i = 0; i < order; ++i) {
+            DDouble xa = half * t_lo[i];
+            DDouble bx = half * t_hi[i];
+            _x_minus_a.set(base + i, xa);
+            _b_minus_x.set(base + i, bx);
+            _x.set(base + i, 2 * i < order ? a + xa : b - bx);
+            _w.set(base + i, half * ref->w()[i]);
+        }
+    }
+    _offsets[nseg] = n;
+}
+
+} /* namespace xprec */
@@ -0,0 +1,263 @@
+/* Quadrature rules stored in memory-mapped files.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/ddouble.h"
+#include "xprec/quadrature.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define XPREC_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define XPREC_HAVE_MMAP 0
+#endif
+
+namespace xprec {
+
+/** Header at the beginning of a rule file */
+struct RuleFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t count;
+    uint64_t reserved;
+};
+
+/** Entry of the table of rules, which follows the header */
+struct RuleFileEntry {
+    uint32_t family;
+    uint32_t n;
+    uint64_t offset;
+};
+
+static const char RULE_FILE_MAGIC[8] = {'X', 'P', 'R', 'E', 'C', 'Q', 'R', 0};
+
+// Written in native byte order, so files from a machine with different byte
+// order are rejected.
+static const uint32_t RULE_FILE_BYTE_ORDER = 0x01020304;
+
+// Arrays are aligned to cache lines
+static const uint64_t RULE_FILE_ALIGN = 64;
+
+static uint64_t rule_file_align(uint64_t offset)
+{
+    return (offset + RULE_FILE_ALIGN - 1) / RULE_FILE_ALIGN * RULE_FILE_ALIGN;
+}
+
+static bool rule_file_less(const RuleFileEntry &a, const RuleFileEntry &b)
+{
+    return a.family < b.family || (a.family == b.family && a.n < b.n);
+}
+
+static const RuleFileEntry *rule_file_table(const unsigned char *data)
+{
+    return reinterpret_cast<const RuleFileEntry *>(data +
+                                                   sizeof(RuleFileHeader));
+}
+
+XPREC_API_EXPORT
+MappedRules::MappedRules(const std::string &path)
+    : _data(nullptr)
+    , _length(0)
+    , _mapped(false)
+    , _ok(false)
+    , _count(0)
+{
+#if XPREC_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            _data = static_cast<const unsigned char *>(addr);
+            _length = st.st_size;
+            _mapped = true;
+        }
+    }
+    ::close(fd);
+#else
+    // Without mmap, we have to read the file into memory instead
+    std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!in)
+        return;
+    _length = in.tellg();
+    _buffer.resize((_length + sizeof(double) - 1) / sizeof(double));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(_buffer.data()), _length)) {
+        _buffer.clear();
+        return;
+    }
+    _data = reinterpret_cast<const unsigned char *>(_buffer.data());
+#endif
+    if (_data == nullptr)
+        return;
+
+    // Validate header and table, but not the data itself
+    RuleFileHeader header;
+    if (_length < sizeof(header)) {
+        unmap();
+        return;
+    }
+    std::memcpy(&header, _data, sizeof(header));
+    if (std::memcmp(header.magic, RULE_FILE_MAGIC, 8) != 0 ||
+        header.version != VERSION ||
+        header.byte_order != RULE_FILE_BYTE_ORDER ||
+        header.count > (_length - sizeof(header)) / sizeof(RuleFileEntry)) {
+        unmap();
+        return;
+    }
+
+    const RuleFileEntry *table = rule_file_table(_data);
+    for (uint64_t i = 0; i != header.count; ++i) {
+        const RuleFileEntry &entry = table[i];
+        bool valid = entry.n >= 1 && entry.offset % sizeof(double) == 0 &&
+                     entry.offset <= _length &&
+                     (_length - entry.offset) / (4 * sizeof(double)) >=
+                         entry.n &&
+                     (i == 0 || rule_file_less(table[i - 1], entry));
+        if (!valid) {
+            unmap();
+            return;
+        }
+    }
+    _count = header.count;
+    _ok = true;
+}
+
+XPREC_API_EXPORT
+MappedRules::~MappedRules() { unmap(); }
+
+XPREC_API_EXPORT
+void MappedRules::unmap()
+{
+#if XPREC_HAVE_MMAP
+    if (_mapped)
+        ::munmap(const_cast<unsigned char *>(_data), _length);
+#endif
+    _buffer.clear();
+    _data = nullptr;
+    _length = 0;
+    _mapped = false;
+    _count = 0;
+}
+
+XPREC_API_EXPORT
+QuadratureRuleView MappedRules::find(QuadratureCache::Family family,
+                                     int n) const
+{
+    QuadratureRuleView view = {0, nullptr, nullptr, nullptr, nullptr};
+    if (_count == 0 || n < 1)
+        return view;
+
+    RuleFileEntry key = {(uint32_t)family, (uint32_t)n, 0};
+    const RuleFileEntry *begin = rule_file_table(_data);
+    const RuleFileEntry *end = begin + _count;
+    const RuleFileEntry *it = std::lower_bound(begin, end, key,
+                                               rule_file_less);
+    if (it == end || it->family != key.family || it->n != key.n)
+        return view;
+
+    const double *base = reinterpret_cast<const double *>(_data + it->offset);
+    view.n = n;
+    view.x_hi = base;
+    view.x_lo = base + n;
+    view.w_hi = base + 2 * n;
+    view.w_lo = base + 3 * n;
+    return view;
+}
+
+XPREC_API_EXPORT
+std::shared_ptr<const MappedRules> load_rules(const std::string &path)
+{
+    std::shared_ptr<const MappedRules> rules =
+        std::make_shared<const MappedRules>(path);
+    if (!rules->ok())
+        return nullptr;
+    return rules;
+}
+
+XPREC_API_EXPORT
+bool save_rules(const std::string &path, QuadratureCache::Family family,
+                const int *n, size_t count)
+{
+    std::vector<int> orders(n, n + count);
+    std::sort(orders.begin(), orders.end());
+    orders.erase(std::unique(orders.begin(), orders.end()), orders.end());
+    if (!orders.empty() && orders.front() < 1)
+        return false;
+
+    RuleFileHeader header;
+    std::memcpy(header.magic, RULE_FILE_MAGIC, sizeof(header.magic));
+    header.version = MappedRules::VERSION;
+    header.byte_order = RULE_FILE_BYTE_ORDER;
+    header.count = orders.size();
+    header.reserved = 0;
+
+    std::vector<RuleFileEntry> table(orders.size());
+    uint64_t offset = rule_file_align(sizeof(header) +
+                                      table.size() * sizeof(RuleFileEntry));
+    for (size_t i = 0; i != orders.size(); ++i) {
+        table[i].family = family;
+        table[i].n = orders[i];
+        table[i].offset = offset;
+        offset = rule_file_align(offset + 4 * sizeof(double) * orders[i]);
+    }
+
+    // Write to a temporary file and rename it over the target only once it
+    // is complete.  Rewriting the target in place would corrupt it for any
+    // process that currently has it mapped into memory.
+#if XPREC_HAVE_MMAP
+    const long pid = (long)getpid();
+#else
+    const long pid = 0;
+#endif
+    const std::string tmp_path = path + ".tmp." + std::to_string(pid);
+    std::ofstream out(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              table.size() * sizeof(RuleFileEntry));
+    std::vector<double> data;
+    for (size_t i = 0; i != orders.size() && out; ++i) {
+        // Compute one rule at a time to bound the memory use
+        std::shared_ptr<const QuadratureRule> rule =
+            make_rule(family, orders[i]);
+        const size_t m = rule->size();
+        data.resize(4 * m);
+        for (size_t j = 0; j != m; ++j) {
+            data[j] = rule->x()[j].hi();
+            data[m + j] = rule->x()[j].lo();
+            data[2 * m + j] = rule->w()[j].hi();
+            data[3 * m + j] = rule->w()[j].lo();
+        }
+
+        std::vector<char> pad(table[i].offset - (uint64_t)out.tellp(), 0);
+        out.write(pad.data(), pad.size());
+        out.write(reinterpret_cast<const char *>(data.data()),
+                  data.size() * sizeof(double));
+    }
+    out.flush();
+    out.close();
+    if (out.fail() || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} /* namespace xprec */
@@ -3,13 +3,10 @@
  * Copyright (C) 2023 Markus Wallerberger and others
  * SPDX-License-Identifier: MIT
  */
+#include "export.h"
 #include "xprec/ddouble.h"
 #include "xprec/internal/utils.h"
 
-#ifndef XPREC_API_EXPORT
-#define XPREC_API_EXPORT
-#endif
-
 namespace xprec {
 
 XPREC_API_EXPORT
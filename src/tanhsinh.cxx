@@ -0,0 +1,254 @@
+/* Tanh-sinh (double exponential) quadrature.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "export.h"
+#include "xprec/ddouble.h"
+#include "xprec/integrate.h"
+#include "xprec/numbers.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace xprec {
+
+/**
+ * Node t > 0 of the trapezoidal rule in the variable t, with u = pi/2 sinh(t),
+ * for the three mappings:
+ *
+ *  - tanh-sinh on [-1, 1]: x = +-(1 - c), with c = exp(-u) / cosh(u),
+ *    weight w = pi/2 cosh(t) / cosh(u)^2.
+ *  - exp-sinh on [0, inf): x = exp(u) with weight w_pos = pi/2 cosh(t)
+ *    exp(u), or x = exp(-u) with weight w_neg for the node -t.
+ *  - sinh-sinh on the real line: x = +-sinh(u), w_sinh = pi/2 cosh(t) cosh(u).
+ */
+struct TanhSinhNode {
+    double t;
+    DDouble c, w, e, inv_e, w_pos, w_neg, s, w_sinh;
+};
+
+/** Largest u for tanh-sinh, where c is still far from underflow */
+static const double TANH_SINH_MAX_U = 340.0;
+
+/** Largest u for exp-sinh and sinh-sinh, where exp(u) does not overflow */
+static const double EXP_SINH_MAX_U = 690.0;
+
+/** Maximum level */
+static const int TANH_SINH_MAX_LEVEL = 12;
+
+/** Round-off floor of the error in units of eps times the integral of |f| */
+static const double TANH_SINH_ROUNDOFF = 16.0;
+
+/**
+ * Compute the nodes of level k: t = j for j = 1, 2, ... on level zero, and
+ * odd multiples of 2^-k on level k > 0.
+ */
+static std::vector<TanhSinhNode> tanh_sinh_level(int k)
+{
+    const double step = std::ldexp(1.0, -k);
+    const double t_max = std::asinh(EXP_SINH_MAX_U / numbers::pi_half.hi());
+    std::vector<TanhSinhNode> nodes;
+    for (int j = 1; j * step <= t_max; j += (k == 0 ? 1 : 2)) {
+        TanhSinhNode node;
+        node.t = j * step;
+
+        DDouble t = node.t;
+        DDouble half_pi_cosh_t = numbers::pi_half * cosh(t);
+        DDouble u = numbers::pi_half * sinh(t);
+        DDouble cosh_u = cosh(u);
+        node.e = exp(u);
+        node.inv_e = reciprocal(node.e);
+        node.c = reciprocal(node.e * cosh_u);
+        node.w = half_pi_cosh_t / (cosh_u * cosh_u);
+        node.w_pos = half_pi_cosh_t * node.e;
+        node.w_neg = half_pi_cosh_t * node.inv_e;
+        node.s = sinh(u);
+        node.w_sinh = half_pi_cosh_t * cosh_u;
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+/** Process-wide tables of nodes and weights, computed on first use */
+class TanhSinhTables {
+public:
+    const std::vector<TanhSinhNode> &get(int k)
+    {
+        assert(k >= 0 && k <= TANH_SINH_MAX_LEVEL);
+        std::lock_guard<std::mutex> lock(_mutex);
+        while ((int)_levels.size() <= k) {
+            _levels.emplace_back(new std::vector<TanhSinhNode>(
+                tanh_sinh_level(_levels.size())));
+        }
+        return *_levels[k];
+    }
+
+    static TanhSinhTables &global()
+    {
+        static TanhSinhTables instance;
+        return instance;
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<const std::vector<TanhSinhNode>>> _levels;
+};
+
+/** Kind of interval, which determines the mapping */
+enum TanhSinhKind {
+    TANH_SINH_FINITE,
+    TANH_SINH_LOWER,
+    TANH_SINH_UPPER,
+    TANH_SINH_REAL
+};
+
+/**
+ * Evaluate the integrand at node on the given side (+1 or -1) and return
+ * the contribution to the trapezoidal sum.
+ */
+static DDouble tanh_sinh_term(const EndpointIntegrand &f, TanhSinhKind kind,
+                              DDouble a, DDouble b, const TanhSinhNode &node,
+                              int side)
+{
+    DDouble half, xc, w;
+    switch (kind) {
+    case TANH_SINH_FINITE:
+        // Nodes on the negative side approach a, on the positive side b
+        half = 0.5 * (b - a);
+        if (side < 0) {
+            xc = half * node.c;
+            return half * node.w * f(a + xc, xc);
+        }
+        xc = -half * node.c;
+        return half * node.w * f(b + xc, xc);
+    case TANH_SINH_LOWER:
+        // [a, inf)
+        xc = side < 0 ? node.inv_e : node.e;
+        w = side < 0 ? node.w_neg : node.w_pos;
+        return w * f(a + xc, xc);
+    case TANH_SINH_UPPER:
+        // (-inf, b]
+        xc = side < 0 ? -node.inv_e : -node.e;
+        w = side < 0 ? node.w_neg : node.w_pos;
+        return w * f(b + xc, xc);
+    case TANH_SINH_REAL:
+    default:
+        xc = side < 0 ? -node.s : node.s;
+        return node.w_sinh * f(xc, xc);
+    }
+}
+
+XPREC_API_EXPORT
+IntegrateResult tanh_sinh(const EndpointIntegrand &f, DDouble a, DDouble b,
+                          DDouble tol, int max_level, DDouble abs_tol)
+{
+    assert(max_level >= 0 && max_level <= TANH_SINH_MAX_LEVEL);
+    assert(!isnan(a) && !isnan(b));
+
+    IntegrateResult result;
+    result.intervals = 1;
+    result.evaluations = 0;
+    result.ok = true;
+    result.error = 0.0;
+    if (a == b) {
+        result.value = 0.0;
+        return result;
+    }
+    if (a > b) {
+        // The distance xc to the closer end point is the same either way
+        result = tanh_sinh(f, b, a, tol, max_level, abs_tol);
+        result.value = -result.value;
+        return result;
+    }
+
+    // Term for the node t = 0
+    TanhSinhKind kind;
+    DDouble center;
+    if (!isinf(a) && !isinf(b)) {
+        kind = TANH_SINH_FINITE;
+        DDouble half = 0.5 * (b - a);
+        center = half * f(a + half, half);
+    } else if (!isinf(a)) {
+        kind = TANH_SINH_LOWER;
+        center = f(a + 1.0, 1.0);
+    } else if (!isinf(b)) {
+        kind = TANH_SINH_UPPER;
+        center = f(b - 1.0, -1.0);
+    } else {
+        kind = TANH_SINH_REAL;
+        center = f(0.0, 0.0);
+    }
+    center *= numbers::pi_half;
+    result.evaluations += 1;
+
+    // Nodes far out on either side are skipped, once the terms on level zero
+    // have become negligible there.
+    const double max_u = kind == TANH_SINH_FINITE ? TANH_SINH_MAX_U
+                                                  : EXP_SINH_MAX_U;
+    const double t_max = std::asinh(max_u / numbers::pi_half.hi());
+    double t_cut[2] = {t_max, t_max};
+
+    TanhSinhTables &tables = TanhSinhTables::global();
+    const DDouble eps = std::numeric_limits<DDouble>::epsilon();
+    DDouble sum = center, prev = 0.0, magnitude = abs(center);
+    for (int k = 0; k <= max_level; ++k) {
+        const std::vector<TanhSinhNode> &nodes = tables.get(k);
+        DDouble sum_abs = abs(center);
+        std::vector<DDouble> terms[2];
+        for (int side = 0; side != 2; ++side) {
+            for (const TanhSinhNode &node : nodes) {
+                if (node.t > t_cut[side])
+                    break;
+                DDouble term = tanh_sinh_term(f, kind, a, b, node,
+                                              2 * side - 1);
+                terms[side].push_back(term);
+                sum += term;
+                sum_abs += abs(term);
+                magnitude += abs(term);
+            }
+            result.evaluations += terms[side].size();
+        }
+
+        if (k == 0) {
+            // Cut after the last term which is not negligible, but keep one
+            // more to be safe.
+            for (int side = 0; side != 2; ++side) {
+                double cut = 0.0;
+                for (size_t j = 0; j != terms[side].size(); ++j) {
+                    if (!(abs(terms[side][j]) <= 1e-35 * sum_abs))
+                        cut = nodes[j].t;
+                }
+                t_cut[side] = std::min(cut + 1.0, t_max);
+            }
+        }
+
+        DDouble value = std::ldexp(1.0, -k) * sum;
+        result.value = value;
+        if (k > 0)
+            result.error = abs(value - prev);
+
+        DDouble target = fmax(tol * abs(value), abs_tol);
+        target = fmax(target, TANH_SINH_ROUNDOFF * eps *
+                                  std::ldexp(1.0, -k) * magnitude);
+        if (k >= 2 && result.error <= target)
+            return result;
+        prev = value;
+    }
+    result.ok = false;
+    return result;
+}
+
+XPREC_API_EXPORT
+IntegrateResult tanh_sinh(const std::function<DDouble(DDouble)> &f, DDouble a,
+                          DDouble b, DDouble tol, int max_level,
+                          DDouble abs_tol)
+{
+    EndpointIntegrand g = [&f](DDouble x, DDouble) { return f(x); };
+    return tanh_sinh(g, a, b, tol, max_level, abs_tol);
+}
+
+} /* namespace xprec */
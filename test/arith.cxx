@@ -7,7 +7,9 @@
 #include "mpfloat.h"
 #include "xprec/ddouble.h"
 #include "xprec/internal/utils.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <vector>
 
 using xprec::ExDouble;
 using xprec::PowerOfTwo;
@@ -32,6 +34,104 @@ TEST_CASE("is_small", "")
     REQUIRE(ExDouble(-1e200).is_small(1e-200));
 }
 
+TEST_CASE("two_prod", "[arith]")
+{
+    using xprec::_internal::two_prod_dekker;
+    using xprec::_internal::two_prod_fma;
+
+    // Include values close to overflow, where the splitting needs scaling
+    for (double a = 1.7e308; a > 1e-140; a *= -.6173) {
+        for (double b = 1.3; fabs(a * b) > 1e-280; b *= -.3731) {
+            if (!std::isfinite(a * b))
+                continue;
+
+            double e_d, e_f;
+            double p_d = two_prod_dekker(a, b, e_d);
+            double p_f = two_prod_fma(a, b, e_f);
+            REQUIRE(p_d == p_f);
+            REQUIRE(e_d == e_f);
+            MPFloat exact = MPFloat(a) * MPFloat(b);
+            REQUIRE((exact == MPFloat(p_d) + MPFloat(e_d)));
+        }
+    }
+}
+
+TEST_CASE("two_prod special", "[arith]")
+{
+    using xprec::_internal::two_prod_dekker;
+    using xprec::_internal::two_prod_fma;
+
+    // Without FMA, the splitting must not blow up for infinite arguments or
+    // overflowing products, and must be exact for subnormal ones.
+    const double special[] = {INFINITY, -INFINITY, 0.0,      -0.0,   1e-310,
+                              -5e-324,  1.7e308,   -1.7e308, 2.0,    NAN};
+    for (double a : special) {
+        for (double b : special) {
+            double e_d, e_f;
+            double p_d = two_prod_dekker(a, b, e_d);
+            double p_f = two_prod_fma(a, b, e_f);
+            REQUIRE((p_d == p_f || (std::isnan(p_d) && std::isnan(p_f))));
+            if (std::isfinite(p_f))
+                REQUIRE(e_d == e_f);
+            else
+                REQUIRE(!std::isfinite(e_d));
+        }
+    }
+
+    // The same through the operators, which use Dekker's algorithm unless
+    // the tests are compiled with FMA.
+    REQUIRE(!isfinite(DDouble(INFINITY) * 2.0));
+    REQUIRE(!isfinite(DDouble(-INFINITY) * DDouble(3.0)));
+    REQUIRE(!isfinite(DDouble(1.0) / 0.0));
+    REQUIRE(!isfinite(reciprocal(DDouble(1e-310))));
+    REQUIRE(!isfinite(sqrt(DDouble(INFINITY))));
+    REQUIRE(DDouble(1e-310) * DDouble(3.0) == 3e-310);
+    REQUIRE(DDouble(0.0) * DDouble(1.7e308) == 0.0);
+    REQUIRE(reciprocal(DDouble(1e300)).hi() == 1 / 1e300);
+}
+
+TEST_CASE("two_prod benchmark", "[.][benchmark]")
+{
+    // Compare both error-free products: with hardware FMA, two_prod_fma
+    // should win by far, while without, std::fma is a library call and
+    // Dekker's product is faster.
+    using xprec::_internal::two_prod_dekker;
+    using xprec::_internal::two_prod_fma;
+
+    const int n = 1024;
+    std::vector<double> a(n), b(n);
+    for (int i = 0; i != n; ++i) {
+        a[i] = 1.0 + i / 1021.0;
+        b[i] = 3.0 - i / 1013.0;
+    }
+
+    BENCHMARK("two_prod_fma")
+    {
+        double s = 0;
+        for (int i = 0; i != n; ++i) {
+            double e;
+            s += two_prod_fma(a[i], b[i], e) + e;
+        }
+        return s;
+    };
+    BENCHMARK("two_prod_dekker")
+    {
+        double s = 0;
+        for (int i = 0; i != n; ++i) {
+            double e;
+            s += two_prod_dekker(a[i], b[i], e) + e;
+        }
+        return s;
+    };
+    BENCHMARK("DDouble product")
+    {
+        DDouble s = 1.0;
+        for (int i = 0; i != n; ++i)
+            s *= DDouble(a[i], 1e-17) * DDouble(b[i], -1e-17);
+        return s;
+    };
+}
+
 TEST_CASE("arith dbl", "[arith]")
 {
     for (double x = 10.0; x > 5.0; x *= .9933) {
@@ -121,6 +221,8 @@ TEST_CASE("Divide pow2", "[arith]")
 {
     CMP_BINARY(operator/, 1, 137, 1e-31);
     REQUIRE_THAT(reciprocal(ExDouble(137)), WithinRel(MPFloat(1) / 137, 1e-21));
+    REQUIRE_THAT(ExDouble(3) / ExDouble(137),
+                 WithinRel(MPFloat(3) / 137, 1e-31));
 }
 
 TEST_CASE("trunc", "[round]")
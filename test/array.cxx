@@ -0,0 +1,96 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/array.h"
+#include "catch2-addons.h"
+#include "xprec/ddouble.h"
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using xprec::DDoubleArray;
+
+static std::vector<DDouble> make_values(size_t n, double scale)
+{
+    std::vector<DDouble> x(n);
+    DDouble v(scale, 1e-17 * scale);
+    for (size_t i = 0; i != n; ++i) {
+        x[i] = v;
+        v *= DDouble(-1.0137, 3.1e-17);
+    }
+    return x;
+}
+
+TEST_CASE("array layout", "[array]")
+{
+    std::vector<DDouble> x = make_values(37, 1.25);
+    DDoubleArray a(x.data(), x.size());
+    REQUIRE(a.size() == 37);
+
+    for (size_t i = 0; i != x.size(); ++i) {
+        REQUIRE(a[i] == x[i]);
+        REQUIRE(a.hi()[i] == x[i].hi());
+        REQUIRE(a.lo()[i] == x[i].lo());
+    }
+
+    std::vector<DDouble> y(x.size());
+    a.set(3, 7.0);
+    a.get(y.data());
+    REQUIRE(y[3] == 7.0);
+    REQUIRE(y[4] == x[4]);
+
+    DDoubleArray b(5, DDouble(2.0, 1e-20));
+    REQUIRE(b[4] == DDouble(2.0, 1e-20));
+}
+
+TEST_CASE("array arith", "[array]")
+{
+    // The kernels implement the same algorithms as the scalar operators,
+    // so sums must agree bit by bit.  Products go through mul_add, which is
+    // a true FMA in the x86-64-v3 copy of the library but Dekker's product
+    // in these inline operators, and the two agree except in rare double
+    // rounding cases.  Allow for those in the last bit of the low part.
+    const double ulp = 2.4651903288156619e-32;
+    std::vector<DDouble> x = make_values(103, 3.5);
+    std::vector<DDouble> y = make_values(103, -0.75);
+    DDoubleArray a(x.data(), x.size()), b(y.data(), y.size()), c;
+
+    add(a, b, c);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE(c[i] == x[i] + y[i]);
+
+    subtract(a, b, c);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE(c[i] == x[i] - y[i]);
+
+    multiply(a, b, c);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE_THAT(c[i], WithinRel(x[i] * y[i], ulp));
+
+    divide(a, b, c);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE_THAT(c[i], WithinRel(x[i] / y[i], ulp));
+
+    reciprocal(b, c);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE_THAT(c[i], WithinRel(reciprocal(y[i]), ulp));
+}
+
+TEST_CASE("array inplace", "[array]")
+{
+    std::vector<DDouble> x = make_values(64, 1.5);
+    DDoubleArray a(x.data(), x.size());
+
+    // See "array arith" for the tolerance of the products
+    const double ulp = 2.4651903288156619e-32;
+    multiply(a, a, a);
+    for (size_t i = 0; i != x.size(); ++i)
+        REQUIRE_THAT(a[i], WithinRel(x[i] * x[i], ulp));
+
+    reciprocal(a, a);
+    for (size_t i = 0; i != x.size(); ++i) {
+        MPFloat x_f = x[i];
+        REQUIRE_THAT(a[i], WithinRel(1 / (x_f * x_f), 10 * ulp));
+    }
+}
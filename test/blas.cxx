@@ -0,0 +1,326 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/blas.h"
+#include "catch2-addons.h"
+#include "mpfloat.h"
+#include "xprec/ddouble.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <vector>
+
+using xprec::ExDouble;
+
+// Error bound of Sum2 and Dot2 for n terms, relative to sum(|x|)
+static double sum2_bound(size_t n) { return (n + 2) * 1.3e-32; }
+
+/**
+ * Make n ill-conditioned pairs (x, y): the terms x * y range over 60
+ * binades and mostly cancel, which leaves a result many orders of
+ * magnitude below sum(|x * y|).
+ */
+static void make_cancelling(size_t n, std::vector<double> &x,
+                            std::vector<double> &y, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> mant(1.0, 2.0);
+    std::uniform_int_distribution<int> expo(-30, 30);
+
+    x.clear();
+    y.clear();
+    while (x.size() + 2 <= n) {
+        double a = std::ldexp(mant(rng), expo(rng));
+        double b = mant(rng);
+        x.push_back(a);
+        y.push_back(b);
+        x.push_back(-a);
+        y.push_back(b);
+    }
+    while (x.size() < n) {
+        x.push_back(std::ldexp(mant(rng), -40));
+        y.push_back(1.0);
+    }
+    for (size_t i = 0; i < n; i += 7)
+        x[i] *= 1.0 + std::ldexp(1.0, -40);
+
+    std::vector<size_t> perm(n);
+    for (size_t i = 0; i != n; ++i)
+        perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), rng);
+
+    std::vector<double> xs(n), ys(n);
+    for (size_t i = 0; i != n; ++i) {
+        xs[i] = x[perm[i]];
+        ys[i] = y[perm[i]];
+    }
+    x.swap(xs);
+    y.swap(ys);
+}
+
+TEST_CASE("sum", "[blas]")
+{
+    REQUIRE(xprec::sum((const double *)nullptr, 0) == 0);
+
+    for (size_t n : {1, 2, 7, 16, 33, 100, 1001}) {
+        std::vector<double> x, y;
+        make_cancelling(n, x, y, n);
+
+        MPFloat exact = 0;
+        double abs_sum = 0;
+        for (size_t i = 0; i != n; ++i) {
+            exact += MPFloat(x[i]);
+            abs_sum += std::fabs(x[i]);
+        }
+        double eps = sum2_bound(n) * abs_sum;
+        REQUIRE_THAT(xprec::sum(x.data(), n), WithinAbs(exact, eps));
+
+        // Same for double-double input with non-trivial lo parts
+        std::vector<DDouble> xx(n);
+        MPFloat exact_dd = 0;
+        for (size_t i = 0; i != n; ++i) {
+            xx[i] = ExDouble(x[i]) + 1e-17 * x[i] * y[i];
+            exact_dd += MPFloat(xx[i]);
+        }
+        REQUIRE_THAT(xprec::sum(xx.data(), n), WithinAbs(exact_dd, eps));
+    }
+
+    std::vector<double> inf = {1.0, INFINITY, 2.0, 3.0, 4.0};
+    REQUIRE(xprec::sum(inf.data(), inf.size()) == INFINITY);
+}
+
+TEST_CASE("dot", "[blas]")
+{
+    REQUIRE(xprec::dot((const double *)nullptr, nullptr, 0) == 0);
+
+    for (size_t n : {1, 2, 7, 16, 33, 100, 1001}) {
+        std::vector<double> x, y;
+        make_cancelling(n, x, y, 3 * n);
+
+        MPFloat exact = 0;
+        double abs_sum = 0;
+        for (size_t i = 0; i != n; ++i) {
+            exact += MPFloat(x[i]) * MPFloat(y[i]);
+            abs_sum += std::fabs(x[i] * y[i]);
+        }
+        double eps = sum2_bound(n) * abs_sum;
+        REQUIRE_THAT(xprec::dot(x.data(), y.data(), n), WithinAbs(exact, eps));
+
+        std::vector<DDouble> xx(n), yy(n);
+        MPFloat exact_dd = 0;
+        for (size_t i = 0; i != n; ++i) {
+            xx[i] = ExDouble(x[i]) + 3e-17 * x[i];
+            yy[i] = ExDouble(y[i]) - 7e-17 * y[i];
+            exact_dd += MPFloat(xx[i]) * MPFloat(yy[i]);
+        }
+        REQUIRE_THAT(xprec::dot(xx.data(), yy.data(), n),
+                     WithinAbs(exact_dd, eps));
+    }
+}
+
+TEST_CASE("reproducible sum", "[blas]")
+{
+    const size_t n = 1001;
+    std::vector<double> x, y;
+    make_cancelling(n, x, y, 17);
+    for (size_t i = 0; i < n; i += 3)
+        x[i] *= 1e-20;
+
+    MPFloat exact = 0;
+    double max_abs = 0;
+    for (size_t i = 0; i != n; ++i) {
+        exact += MPFloat(x[i]);
+        max_abs = std::max(max_abs, std::fabs(x[i]));
+    }
+    DDouble r = xprec::reproducible_sum(x.data(), n);
+    REQUIRE_THAT(r, WithinAbs(exact, 1e-32 * max_abs));
+
+    // Chunk the input differently and merge in a different order: the
+    // result must be identical bit by bit.
+    std::mt19937 rng(4711);
+    for (int trial = 0; trial != 10; ++trial) {
+        std::shuffle(x.begin(), x.end(), rng);
+        std::vector<xprec::ReproducibleSum> parts;
+        size_t start = 0;
+        while (start < n) {
+            size_t len = std::min<size_t>(n - start, 1 + rng() % 97);
+            parts.emplace_back(max_abs, n);
+            if (len % 2)
+                parts.back().add(x.data() + start, len);
+            else
+                for (size_t i = start; i != start + len; ++i)
+                    parts.back().add(x[i]);
+            start += len;
+        }
+        xprec::ReproducibleSum total(max_abs, n);
+        for (size_t k = parts.size(); k-- != 0;)
+            total += parts[k];
+
+        DDouble r_trial = total.result();
+        REQUIRE(r_trial.hi() == r.hi());
+        REQUIRE(r_trial.lo() == r.lo());
+    }
+
+    // Double-double input
+    std::vector<DDouble> xx(n);
+    MPFloat exact_dd = 0;
+    for (size_t i = 0; i != n; ++i) {
+        xx[i] = ExDouble(x[i]) + 1e-17 * x[i] * y[i];
+        exact_dd += MPFloat(xx[i]);
+    }
+    DDouble r_dd = xprec::reproducible_sum(xx.data(), n);
+    REQUIRE_THAT(r_dd, WithinAbs(exact_dd, 1e-32 * max_abs));
+    std::reverse(xx.begin(), xx.end());
+    REQUIRE(xprec::reproducible_sum(xx.data(), n).hi() == r_dd.hi());
+    REQUIRE(xprec::reproducible_sum(xx.data(), n).lo() == r_dd.lo());
+}
+
+TEST_CASE("reproducible sum beyond max_n", "[blas]")
+{
+    // Accumulators sized for a few terms only must renormalize, but still
+    // give the same result bit by bit, no matter how the terms are split.
+    const size_t n = 1001;
+    std::vector<double> x, y;
+    make_cancelling(n, x, y, 23);
+    MPFloat exact = 0;
+    double max_abs = 0;
+    for (size_t i = 0; i != n; ++i) {
+        exact += MPFloat(x[i]);
+        max_abs = std::max(max_abs, std::fabs(x[i]));
+    }
+
+    xprec::ReproducibleSum ref(max_abs, 3);
+    ref.add(x.data(), n);
+    DDouble r = ref.result();
+    REQUIRE_THAT(r, WithinAbs(exact, 1e-32 * max_abs));
+
+    std::mt19937 rng(815);
+    for (int trial = 0; trial != 10; ++trial) {
+        std::shuffle(x.begin(), x.end(), rng);
+        xprec::ReproducibleSum total(max_abs, 3);
+        size_t start = 0;
+        while (start < n) {
+            size_t len = std::min<size_t>(n - start, 1 + rng() % 13);
+            xprec::ReproducibleSum part(max_abs, 3);
+            if (len % 2)
+                part.add(x.data() + start, len);
+            else
+                for (size_t i = start; i != start + len; ++i)
+                    part.add(x[i]);
+            total += part;
+            start += len;
+        }
+        DDouble r_trial = total.result();
+        REQUIRE(r_trial.hi() == r.hi());
+        REQUIRE(r_trial.lo() == r.lo());
+    }
+
+    // Double-double terms count twice
+    std::vector<DDouble> xx(n);
+    for (size_t i = 0; i != n; ++i)
+        xx[i] = x[i];
+    xprec::ReproducibleSum acc(max_abs, 3);
+    acc.add(xx.data(), n);
+    REQUIRE(acc.result().hi() == r.hi());
+    REQUIRE(acc.result().lo() == r.lo());
+}
+
+TEST_CASE("reproducible sum range", "[blas]")
+{
+    // Close to overflow and into the subnormal range
+    std::vector<double> x = {1.5e308, -1.4e308, 3.0, 1e300, -1e300};
+    DDouble r = xprec::reproducible_sum(x.data(), x.size());
+    REQUIRE(r.hi() == 1.5e308 - 1.4e308);
+
+    std::vector<double> tiny = {3e-310, 1e-320, -2e-310, 5e-324};
+    r = xprec::reproducible_sum(tiny.data(), tiny.size());
+    REQUIRE(r == (3e-310 - 2e-310) + 1e-320 + 5e-324);
+
+    std::vector<double> inf = {1.0, INFINITY, 2.0, 3.0, 4.0, 5.0, 6.0};
+    REQUIRE(xprec::reproducible_sum(inf.data(), inf.size()) == INFINITY);
+    inf.push_back(-INFINITY);
+    REQUIRE(isnan(xprec::reproducible_sum(inf.data(), inf.size())));
+
+    REQUIRE(xprec::reproducible_sum((const double *)nullptr, 0) == 0);
+}
+
+static std::vector<DDouble> make_matrix(size_t rows, size_t cols, size_t ld,
+                                        unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<DDouble> a(ld * cols);
+    for (size_t j = 0; j != cols; ++j) {
+        for (size_t i = 0; i != rows; ++i)
+            a[i + j * ld] = ExDouble(dist(rng)) + 1e-17 * dist(rng);
+    }
+    return a;
+}
+
+TEST_CASE("gemm", "[blas]")
+{
+    const DDouble alpha(0.75, 1e-18), beta(-1.25, 3e-17);
+    for (size_t m : {1, 7, 67}) {
+        for (size_t n : {3, 66}) {
+            for (size_t k : {1, 5, 130}) {
+                const size_t lda = m + 3, ldb = k + 1, ldc = m + 2;
+                std::vector<DDouble> a = make_matrix(m, k, lda, 1);
+                std::vector<DDouble> b = make_matrix(k, n, ldb, 2);
+                std::vector<DDouble> c = make_matrix(m, n, ldc, 3);
+                std::vector<DDouble> c0 = c;
+
+                xprec::gemm(m, n, k, alpha, a.data(), lda, b.data(), ldb, beta,
+                            c.data(), ldc);
+                for (size_t j = 0; j != n; ++j) {
+                    for (size_t i = 0; i != m; ++i) {
+                        DDouble ref = 0.0;
+                        for (size_t p = 0; p != k; ++p)
+                            ref += a[i + p * lda] * b[p + j * ldb];
+                        ref = alpha * ref + beta * c0[i + j * ldc];
+                        REQUIRE_THAT(c[i + j * ldc],
+                                     WithinAbs(ref, k * 1e-31 + 1e-31));
+                    }
+                }
+
+                // Padding between columns must be untouched
+                for (size_t j = 0; j != n; ++j) {
+                    for (size_t i = m; i != ldc; ++i)
+                        REQUIRE(c[i + j * ldc] == c0[i + j * ldc]);
+                }
+            }
+        }
+    }
+
+    // beta = 0 must overwrite NaNs in C
+    std::vector<DDouble> a = make_matrix(5, 4, 5, 4);
+    std::vector<DDouble> b = make_matrix(4, 3, 4, 5);
+    std::vector<DDouble> c(15, NAN);
+    xprec::gemm(5, 3, 4, 1.0, a.data(), 5, b.data(), 4, 0.0, c.data(), 5);
+    for (size_t i = 0; i != c.size(); ++i)
+        REQUIRE(isfinite(c[i]));
+}
+
+TEST_CASE("gemv", "[blas]")
+{
+    const DDouble alpha(-0.5, 1e-18), beta(2.0, 1e-17);
+    for (size_t m : {1, 13, 300}) {
+        for (size_t n : {1, 17, 200}) {
+            const size_t lda = m + 1;
+            std::vector<DDouble> a = make_matrix(m, n, lda, 6);
+            std::vector<DDouble> x = make_matrix(n, 1, n, 7);
+            std::vector<DDouble> y = make_matrix(m, 1, m, 8);
+            std::vector<DDouble> y0 = y;
+
+            xprec::gemv(m, n, alpha, a.data(), lda, x.data(), beta, y.data());
+            for (size_t i = 0; i != m; ++i) {
+                DDouble ref = 0.0;
+                for (size_t j = 0; j != n; ++j)
+                    ref += a[i + j * lda] * x[j];
+                ref = alpha * ref + beta * y0[i];
+                REQUIRE_THAT(y[i], WithinAbs(ref, n * 1e-31 + 1e-31));
+            }
+        }
+    }
+}
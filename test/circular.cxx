@@ -6,7 +6,9 @@
 #include "catch2-addons.h"
 #include "mpfloat.h"
 #include "xprec/ddouble.h"
+#include "xprec/numbers.h"
 #include <catch2/catch_test_macros.hpp>
+#include <vector>
 
 MPFloat trig_complement(MPFloat x) { return sqrt(1 - x * x); }
 
@@ -92,6 +94,115 @@ TEST_CASE("tan", "[trig]")
     }
 }
 
+TEST_CASE("sincos", "[trig]")
+{
+    DDouble x = M_PI / 4;
+    while ((x *= 1.07) < 1e6) {
+        DDouble s, c;
+        sincos(x, s, c);
+        REQUIRE(s == sin(x));
+        REQUIRE(c == cos(x));
+        sincos(-x, s, c);
+        REQUIRE(s == sin(-x));
+        REQUIRE(c == cos(-x));
+    }
+}
+
+TEST_CASE("sincos large", "[trig]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // The reduction is exact, so even huge values are accurate in absolute
+    DDouble x = 1e6;
+    while ((x *= 1.13) < 1e300) {
+        DDouble xl = x + 0.3;
+        CMP_UNARY_ABS(sin, x, 1 * ulp);
+        CMP_UNARY_ABS(cos, -x, 1 * ulp);
+        CMP_UNARY_ABS(sin, xl, 1 * ulp);
+        CMP_UNARY_ABS(cos, xl, 1 * ulp);
+    }
+
+    // Close to multiples of pi/2, the error is far below the ulp of x
+    for (double n = 1; n < 1e14; n *= 7.1) {
+        DDouble y = xprec::numbers::pi_half * std::round(n);
+        CMP_UNARY_ABS(sin, y, 1e-16 * ulp * fabs(y.hi()));
+        CMP_UNARY_ABS(cos, y, 1e-16 * ulp * fabs(y.hi()));
+    }
+
+    REQUIRE(isnan(sin(DDouble(INFINITY))));
+    REQUIRE(isnan(cos(DDouble(-INFINITY))));
+    REQUIRE(isnan(sin(DDouble(NAN))));
+}
+
+TEST_CASE("sincos table", "[trig]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // The kernel splits off a = k/64, so that abs(x - a) <= 1/128.  Place
+    // x either side of the points (k + 1/2)/64, where k switches to k + 1,
+    // as well as close to the end of the table at pi/4.
+    std::vector<DDouble> x;
+    for (int k = 0; k != 50; ++k)
+        x.push_back((k + 0.5) / 64);
+    x.push_back(xprec::numbers::pi_4);
+
+    for (DDouble b : x) {
+        for (int s = -2; s <= 2; ++s) {
+            DDouble xi = b * (1.0 + s * 2.3e-16) + s * 3e-18;
+            CMP_UNARY(sin, xi, 1 * ulp);
+            CMP_UNARY(sin, -xi, 1 * ulp);
+            CMP_UNARY(cos, xi, 1 * ulp);
+            CMP_UNARY(cos, -xi, 1 * ulp);
+
+            // The same reduced arguments in the other sectors
+            for (int n = 1; n != 4; ++n) {
+                DDouble y = xprec::numbers::pi_half * n + xi;
+                CMP_UNARY_ABS(sin, y, 1.5 * ulp * fabs(y.hi()));
+                CMP_UNARY_ABS(cos, y, 1.5 * ulp * fabs(y.hi()));
+            }
+        }
+    }
+}
+
+TEST_CASE("batch trig", "[trig]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // Hit all sectors and their boundaries
+    std::vector<DDouble> x;
+    for (DDouble xi = 1e-290; xi < 1e6; xi *= 1.3) {
+        x.push_back(xi);
+        x.push_back(-xi);
+    }
+    for (int i = -40; i <= 40; ++i)
+        x.push_back(i * xprec::numbers::pi_4);
+    const size_t n = x.size();
+
+    std::vector<DDouble> s(n), c(n), t(n);
+    sincos(x.data(), s.data(), c.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        double eps = 1.5 * ulp * std::max(1.0, fabs(x[i].hi()));
+        REQUIRE_THAT(s[i], WithinAbs(sin(MPFloat(x[i])), eps));
+        REQUIRE_THAT(c[i], WithinAbs(cos(MPFloat(x[i])), eps));
+    }
+
+    sin(x.data(), t.data(), n);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE(t[i] == s[i]);
+
+    cos(x.data(), t.data(), n);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE(t[i] == c[i]);
+
+    // In-place operation
+    t = x;
+    tan(t.data(), t.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (fabs(x[i]) < M_PI / 4)
+            REQUIRE_THAT(t[i], WithinRel(tan(MPFloat(x[i])), 2 * ulp));
+    }
+}
+
 TEST_CASE("asin", "[trig]")
 {
     CMP_UNARY(asin, 0.0, 1e-31);
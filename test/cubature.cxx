@@ -0,0 +1,152 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.h"
+#include "xprec/cubature.h"
+#include "xprec/ddouble.h"
+#include "xprec/numbers.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <set>
+#include <vector>
+
+using xprec::CubatureRule;
+using xprec::DDouble;
+using xprec::QuadratureCache;
+
+TEST_CASE("tensor-rule", "[cubature]")
+{
+    for (int dim : {1, 2, 3}) {
+        for (int n : {1, 5, 12}) {
+            CubatureRule rule =
+                xprec::tensor_rule(QuadratureCache::GAUSS_LEGENDRE, dim, n);
+            CAPTURE(dim);
+            CAPTURE(n);
+            REQUIRE(rule.dim() == dim);
+            REQUIRE(rule.size() == size_t(std::pow(n, dim)));
+
+            // Every node of the grid appears exactly once
+            std::vector<DDouble> x(n), w(n);
+            gauss_legendre(n, x.data(), w.data());
+            std::set<std::vector<DDouble>> seen;
+            DDouble sum = 0.0;
+            for (size_t i = 0; i != rule.size(); ++i) {
+                std::vector<DDouble> node(dim);
+                for (int k = 0; k != dim; ++k)
+                    node[k] = rule.x(k)[i];
+                seen.insert(node);
+                sum += rule.w()[i];
+            }
+            REQUIRE(seen.size() == rule.size());
+            REQUIRE_THAT(sum, WithinRel(DDouble(std::pow(2.0, dim)), 1e-30));
+        }
+    }
+
+    // Nodes are tiled: the first 64 nodes in 2D form an 8 x 8 block
+    CubatureRule rule =
+        xprec::tensor_rule(QuadratureCache::GAUSS_LEGENDRE, 2, 20);
+    std::vector<DDouble> x(20);
+    gauss_legendre(20, x.data());
+    for (size_t i = 0; i != 64; ++i) {
+        REQUIRE(rule.x(0)[i] <= x[7]);
+        REQUIRE(rule.x(1)[i] <= x[7]);
+    }
+}
+
+TEST_CASE("smolyak-rule", "[cubature]")
+{
+    // Exact for polynomials of total degree 2 level + 1
+    for (int dim : {1, 2, 3, 4}) {
+        for (int level : {0, 1, 3, 5}) {
+            CubatureRule rule =
+                xprec::smolyak_rule(QuadratureCache::GAUSS_LEGENDRE, dim,
+                                    level);
+            CAPTURE(dim);
+            CAPTURE(level);
+
+            std::vector<int> p(dim, 0);
+            for (;;) {
+                int degree = 0;
+                DDouble exact = 1.0;
+                for (int k = 0; k != dim; ++k) {
+                    degree += p[k];
+                    exact *= p[k] % 2 ? DDouble(0.0)
+                                      : DDouble(2.0) / (p[k] + 1.0);
+                }
+                if (degree <= 2 * level + 1) {
+                    DDouble sum = 0.0;
+                    for (size_t i = 0; i != rule.size(); ++i) {
+                        DDouble term = rule.w()[i];
+                        for (int k = 0; k != dim; ++k)
+                            term *= pow(rule.x(k)[i], p[k]);
+                        sum += term;
+                    }
+                    CAPTURE(p);
+                    REQUIRE_THAT(sum, WithinAbs(exact, 1e-29));
+                }
+
+                int k = dim - 1;
+                for (; k >= 0; --k) {
+                    if (++p[k] <= 2 * level + 1)
+                        break;
+                    p[k] = 0;
+                }
+                if (k < 0)
+                    break;
+            }
+        }
+    }
+
+    // Much smaller than the tensor product of the same degree
+    CubatureRule sparse =
+        xprec::smolyak_rule(QuadratureCache::GAUSS_LEGENDRE, 6, 4);
+    REQUIRE(sparse.size() < 15625 / 10);
+
+    // Gauss-Chebyshev for the weight prod_k 1/sqrt(1 - x[k]^2)
+    const DDouble pi = xprec::numbers::pi;
+    CubatureRule cheb =
+        xprec::smolyak_rule(QuadratureCache::GAUSS_CHEBYSHEV, 2, 3);
+    DDouble sum = 0.0;
+    for (size_t i = 0; i != cheb.size(); ++i) {
+        DDouble x = cheb.x(0)[i], y = cheb.x(1)[i];
+        sum += cheb.w()[i] * x * x * y * y * y * y;
+    }
+    REQUIRE_THAT(sum, WithinRel(pi * pi * 3.0 / 16.0, 1e-30));
+
+    // The middle nodes of the odd-sized rules coincide, as for Legendre
+    cheb = xprec::smolyak_rule(QuadratureCache::GAUSS_CHEBYSHEV, 3, 4);
+    sparse = xprec::smolyak_rule(QuadratureCache::GAUSS_LEGENDRE, 3, 4);
+    REQUIRE(cheb.size() == sparse.size());
+}
+
+TEST_CASE("cubature", "[cubature]")
+{
+    std::atomic<size_t> points(0);
+    xprec::CubatureIntegrand f = [&](const DDouble *const *x, DDouble *fx,
+                                     size_t n) {
+        points += n;
+        for (size_t i = 0; i != n; ++i)
+            fx[i] = exp(x[0][i] + 2.0 * x[1][i] - x[2][i]);
+    };
+
+    // Integral of exp(x + 2y - z) over [0, 1] x [-1, 0] x [0, 2]
+    const DDouble a[] = {0.0, -1.0, 0.0}, b[] = {1.0, 0.0, 2.0};
+    DDouble exact = (exp(DDouble(1.0)) - 1.0) * (1.0 - exp(DDouble(-2.0))) /
+                    2.0 * (1.0 - exp(DDouble(-2.0)));
+
+    CubatureRule rule =
+        xprec::tensor_rule(QuadratureCache::GAUSS_LEGENDRE, 3, 20);
+    DDouble serial = xprec::cubature(f, rule, a, b, 1);
+    REQUIRE(points == rule.size());
+    REQUIRE_THAT(serial, WithinRel(exact, 1e-30));
+
+    // Result does not depend on the number of threads
+    REQUIRE(xprec::cubature(f, rule, a, b, 4) == serial);
+
+    CubatureRule sparse =
+        xprec::smolyak_rule(QuadratureCache::GAUSS_LEGENDRE, 3, 16);
+    REQUIRE_THAT(xprec::cubature(f, sparse, a, b), WithinRel(exact, 1e-29));
+}
@@ -22,3 +22,54 @@ TEST_CASE("eigenvalues", "[eigen]")
     Eigen::SelfAdjointEigenSolver<decltype(A)> A_eig(A);
     // TODO
 }
+
+TEST_CASE("eigen packets", "[eigen]")
+{
+    using Eigen::Dynamic;
+    typedef Eigen::Matrix<DDouble, Dynamic, Dynamic> Matrix;
+    typedef Eigen::Matrix<DDouble, Dynamic, 1> Vector;
+
+    // Vectorized and scalar paths sum in different order
+    const int n = 37;
+    Matrix A(n, n), B(n, n + 2);
+    for (int j = 0; j != A.cols(); ++j)
+        for (int i = 0; i != A.rows(); ++i)
+            A(i, j) = xprec::reciprocal(xprec::ExDouble(i + j + 1));
+    for (int j = 0; j != B.cols(); ++j)
+        for (int i = 0; i != B.rows(); ++i)
+            B(i, j) = DDouble(i - j) / 7;
+
+    Matrix C = A * B;
+    for (int j = 0; j != C.cols(); ++j) {
+        for (int i = 0; i != C.rows(); ++i) {
+            DDouble ref = 0;
+            for (int k = 0; k != n; ++k)
+                ref += A(i, k) * B(k, j);
+            REQUIRE_THAT(C(i, j), WithinAbs(ref, 1e-30));
+        }
+    }
+
+    Vector x = B.col(3);
+    Vector y = A.transpose() * x;
+    DDouble sum = 0, sum_sq = 0;
+    for (int i = 0; i != n; ++i) {
+        DDouble ref = 0;
+        for (int k = 0; k != n; ++k)
+            ref += A(k, i) * x(k);
+        REQUIRE_THAT(y(i), WithinAbs(ref, 1e-30));
+        sum += x(i);
+        sum_sq += x(i) * x(i);
+    }
+    REQUIRE_THAT(x.sum(), WithinAbs(sum, 1e-30));
+    REQUIRE_THAT(x.squaredNorm(), WithinRel(sum_sq, 1e-30));
+
+    Matrix D = (A.array() * B.leftCols(n).array() - A.array() / 3.0).matrix();
+    for (int j = 0; j != n; ++j)
+        for (int i = 0; i != n; ++i)
+            REQUIRE_THAT(D(i, j), WithinAbs(A(i, j) * B(i, j) - A(i, j) / 3.0,
+                                            1e-31));
+
+    Vector r = x.reverse();
+    REQUIRE(r(0) == x(n - 1));
+    REQUIRE(r(n - 1) == x(0));
+}
@@ -7,6 +7,7 @@
 #include "mpfloat.h"
 #include "xprec/ddouble.h"
 #include <catch2/catch_test_macros.hpp>
+#include <vector>
 
 TEST_CASE("pow", "[fn]")
 {
@@ -110,3 +111,214 @@ TEST_CASE("log1p", "[exp]")
         CMP_UNARY(log1p, x, 1.0 * ulp);
     }
 }
+
+static std::vector<DDouble> log_reduction_points()
+{
+    // Close to 1, log(x) must be accurate relative to itself.  Below 1e-40,
+    // 1 + d is no longer exact in the precision of MPFloat.
+    std::vector<DDouble> x;
+    for (double d = 1e-3; d > 1e-40; d *= 0.31) {
+        x.push_back(1.0 + DDouble(d));
+        x.push_back(1.0 - DDouble(d));
+    }
+
+    // Either side of the table entries c = 1 + k/128, where the truncation
+    // switches between k - 1 and k, and of the exponent split at sqrt(2).
+    std::vector<double> m;
+    for (int k = -38; k <= 54; ++k)
+        m.push_back(1.0 + k / 128.0);
+    m.push_back(1.4142135623730951);
+    m.push_back(0.7071067811865476);
+    for (double mi : m) {
+        for (int s = -2; s <= 2; ++s) {
+            DDouble xi = mi * (1.0 + s * 2.3e-16);
+            x.push_back(xi);
+            x.push_back(xi + s * 3e-18);
+            x.push_back(ldexp(xi, 700));
+            x.push_back(ldexp(xi, -700));
+        }
+    }
+    return x;
+}
+
+TEST_CASE("log reduction", "[exp]")
+{
+    const double ulp = 2.4651903288156619e-32;
+    for (DDouble x : log_reduction_points()) {
+        CMP_UNARY(log, x, 1.0 * ulp);
+
+        // For tiny x, x - 1 is not exact in the precision of MPFloat
+        if (x > 0.5)
+            CMP_UNARY(log1p, x - 1.0, 2.5 * ulp);
+    }
+}
+
+TEST_CASE("batch exp", "[exp]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // Mix in values that are outside the range of the vectorized kernels,
+    // which must be recomputed by the scalar code.
+    std::vector<DDouble> x;
+    for (DDouble xi = 1e-20; xi < 700.0; xi *= 1.17) {
+        x.push_back(xi);
+        x.push_back(-xi);
+    }
+    x.push_back(DDouble(0.1, 1e-18));
+    x.push_back(-1000.0);
+    x.push_back(1000.0);
+    x.push_back(NAN);
+    x.push_back(708.5);
+    x.push_back(-0.25);
+    x.push_back(0.25);
+    const size_t n = x.size();
+
+    std::vector<DDouble> y(n);
+    exp(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (isnan(x[i]))
+            REQUIRE(isnan(y[i]));
+        else if (x[i] > -670.0 && x[i] < 708.0)
+            REQUIRE_THAT(y[i], WithinRel(exp(MPFloat(x[i])), 2.0 * ulp));
+        else
+            REQUIRE(y[i] == exp(x[i]));
+    }
+
+    expm1(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (isnan(x[i]))
+            REQUIRE(isnan(y[i]));
+        else if (x[i] > -670.0 && x[i] < 708.0)
+            REQUIRE_THAT(y[i], WithinRel(expm1(MPFloat(x[i])), 2.0 * ulp));
+        else
+            REQUIRE(y[i] == expm1(x[i]));
+    }
+
+    // In-place operation
+    std::vector<DDouble> z = x;
+    exp(z.data(), z.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (x[i] > -670.0 && x[i] < 708.0)
+            REQUIRE_THAT(z[i], WithinRel(exp(x[i]), 2.0 * ulp));
+    }
+}
+
+TEST_CASE("batch exp reduction", "[exp]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    // Arguments x = (128 k + j + 1/2) ln(2)/128 lie on the boundaries between
+    // table entries j, where k changes for j = 63.  Include the largest and
+    // smallest k as well as the kernel limits near +-708.
+    const DDouble ln2_128th = log(DDouble(2.0)) / 128.0;
+    std::vector<DDouble> x;
+    for (int k : {-1021, -1020, -700, -2, -1, 0, 1, 2, 500, 1020, 1021}) {
+        for (int j : {-65, -64, -33, -1, 0, 31, 62, 63}) {
+            DDouble xb = (128.0 * k + j + 0.5) * ln2_128th;
+            for (int s = -3; s <= 3; ++s)
+                x.push_back(xb + s * 2e-16 * xb.hi());
+        }
+    }
+    for (double xe : {707.99, 708.0 - 1e-13, 708.0}) {
+        x.push_back(xe);
+        x.push_back(-xe);
+    }
+    const size_t n = x.size();
+
+    std::vector<DDouble> y(n);
+    exp(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        REQUIRE_THAT(y[i], WithinRel(exp(x[i]), 2.0 * ulp));
+        if (x[i] > -670.0 && x[i] < 708.0)
+            REQUIRE_THAT(y[i], WithinRel(exp(MPFloat(x[i])), 2.0 * ulp));
+    }
+
+    expm1(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        REQUIRE_THAT(y[i], WithinRel(expm1(x[i]), 2.0 * ulp));
+        if (x[i] > -670.0 && x[i] < 708.0)
+            REQUIRE_THAT(y[i], WithinRel(expm1(MPFloat(x[i])), 2.0 * ulp));
+    }
+}
+
+TEST_CASE("batch log", "[exp]")
+{
+    const double ulp = 2.4651903288156619e-32;
+
+    std::vector<DDouble> x;
+    for (DDouble xi = 1e-290; xi < 1e300; xi *= 1.37)
+        x.push_back(xi);
+    x.push_back(0.0);
+    x.push_back(-1.0);
+    x.push_back(INFINITY);
+    x.push_back(DDouble(3.0, 1e-17));
+    const size_t n = x.size();
+
+    std::vector<DDouble> y(n);
+    log(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (x[i] > 0.0 && isfinite(x[i]))
+            REQUIRE_THAT(y[i], WithinRel(log(MPFloat(x[i])), 2.0 * ulp));
+        else
+            REQUIRE((y[i] == log(x[i]) || (isnan(y[i]) && isnan(log(x[i])))));
+    }
+
+    std::vector<DDouble> u;
+    for (DDouble ui = 1e-290; ui < 1e300; ui *= 1.37)
+        u.push_back(ui);
+    for (DDouble ui = -.9999999; ui < -1e-290; ui *= 0.92)
+        u.push_back(ui);
+    u.push_back(-1.0);
+    u.push_back(-2.0);
+    const size_t m = u.size();
+
+    std::vector<DDouble> v(m);
+    log1p(u.data(), v.data(), m);
+    for (size_t i = 0; i != m; ++i) {
+        if (u[i] > -1.0)
+            REQUIRE_THAT(v[i], WithinRel(log1p(MPFloat(u[i])), 2.5 * ulp));
+        else
+            REQUIRE((v[i] == log1p(u[i]) || (isnan(v[i]) && isnan(log1p(u[i])))));
+    }
+}
+
+TEST_CASE("batch log reduction", "[exp]")
+{
+    const double ulp = 2.4651903288156619e-32;
+    std::vector<DDouble> x = log_reduction_points();
+    const size_t n = x.size();
+
+    std::vector<DDouble> y(n);
+    log(x.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE_THAT(y[i], WithinRel(log(MPFloat(x[i])), 1.0 * ulp));
+
+    std::vector<DDouble> u(n);
+    for (size_t i = 0; i != n; ++i)
+        u[i] = x[i] - 1.0;
+    log1p(u.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i) {
+        if (x[i] > 0.5)
+            REQUIRE_THAT(y[i], WithinRel(log1p(MPFloat(u[i])), 2.5 * ulp));
+    }
+}
+
+TEST_CASE("batch pow", "[exp]")
+{
+    std::vector<DDouble> x, y;
+    for (int i = 0; i != 600; ++i) {
+        x.push_back(0.5 + 0.01 * i);
+        y.push_back(-30.0 + 0.1 * i);
+    }
+    const size_t n = x.size();
+
+    std::vector<DDouble> z(n);
+    pow(x.data(), y.data(), z.data(), n);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE_THAT(z[i], WithinRel(pow(x[i], y[i]), 1e-30));
+
+    // Output aliases second input
+    pow(x.data(), y.data(), y.data(), n);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE(y[i] == z[i]);
+}
@@ -4,7 +4,10 @@
  * SPDX-License-Identifier: MIT
  */
 #include "catch2-addons.h"
+#include "mpfloat.h"
 #include "xprec/ddouble.h"
+#include "xprec/numbers.h"
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <numeric>
 #include <vector>
@@ -89,3 +92,316 @@ TEST_CASE("leg-cmp-16", "[gauss]")
         REQUIRE_THAT(w[i], WithinAbs(w_ref[i], 0.2 * 1e-31));
     }
 }
+
+/** Evaluate P_n(x) and its derivative in multiple precision */
+static void leg_deriv_mp(int n, const MPFloat &x, MPFloat &P, MPFloat &dP)
+{
+    MPFloat P_1 = 1, dP_1 = 0;
+    P = x;
+    dP = 1;
+    for (int k = 1; k < n; ++k) {
+        MPFloat P_next = (MPFloat(2 * k + 1) * x * P - MPFloat(k) * P_1) /
+                         MPFloat(k + 1);
+        MPFloat dP_next =
+            (MPFloat(2 * k + 1) * (x * dP + P) - MPFloat(k) * dP_1) /
+            MPFloat(k + 1);
+        P_1 = P;
+        P = P_next;
+        dP_1 = dP;
+        dP = dP_next;
+    }
+}
+
+TEST_CASE("leg-asymptotic", "[gauss]")
+{
+    for (int n : {100, 257, 1000}) {
+        std::vector<DDouble> x(n), w(n);
+        gauss_legendre(n, x.data(), w.data());
+
+        // Compare nodes close to the end point, where the recurrence is used,
+        // and beyond, with a multiple-precision Newton iteration.
+        for (int i : {0, 1, 5, 11, 12, 13, 14, 20, n / 3, n / 2}) {
+            MPFloat x_mp(x[i]), P, dP;
+            for (int iter = 0; iter < 2; ++iter) {
+                leg_deriv_mp(n, x_mp, P, dP);
+                x_mp = x_mp - P / dP;
+            }
+            leg_deriv_mp(n, x_mp, P, dP);
+            MPFloat w_mp = MPFloat(2) / ((MPFloat(1) - x_mp * x_mp) * dP * dP);
+
+            CAPTURE(n);
+            CAPTURE(i);
+            REQUIRE_THAT(x[i], WithinAbs(x_mp, 5e-32));
+            REQUIRE_THAT(w[i], WithinRel(w_mp, 2e-30));
+        }
+
+        // Symmetry and exactness for polynomials up to degree 2n - 1
+        DDouble sum_w = 0.0, moment = 0.0;
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(x[i] == -x[n - 1 - i]);
+            REQUIRE(w[i] == w[n - 1 - i]);
+            sum_w += w[i];
+            moment += w[i] * pow(x[i], 2 * n - 2);
+        }
+        REQUIRE_THAT(sum_w, WithinRel(DDouble(2.0), 1e-31));
+        REQUIRE_THAT(moment, WithinRel(2.0 / DDouble(2 * n - 1), 1e-29));
+    }
+}
+
+TEST_CASE("leg-symmetric", "[gauss]")
+{
+    // Orders below the asymptotic construction, where only half of the nodes
+    // are refined, some of them on several threads
+    for (int n : {1, 2, 3, 64, 99}) {
+        std::vector<DDouble> x(n), w(n);
+        gauss_legendre(n, x.data(), w.data());
+
+        DDouble sum_w = 0.0, moment = 0.0;
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(x[i] == -x[n - 1 - i]);
+            REQUIRE(w[i] == w[n - 1 - i]);
+            sum_w += w[i];
+            moment += w[i] * pow(x[i], 2 * n - 2);
+        }
+        REQUIRE_THAT(sum_w, WithinRel(DDouble(2.0), 1e-31));
+        REQUIRE_THAT(moment, WithinRel(2.0 / DDouble(2 * n - 1), 1e-29));
+    }
+}
+
+static DDouble rule_moment(const std::vector<DDouble> &x,
+                           const std::vector<DDouble> &w, int k)
+{
+    DDouble sum = 0.0;
+    for (size_t i = 0; i != x.size(); ++i)
+        sum += w[i] * pow(x[i], k);
+    return sum;
+}
+
+TEST_CASE("jacobi-special", "[gauss]")
+{
+    // Chebyshev polynomials of the first kind
+    std::vector<DDouble> x(13), w(13), x_ref(13), w_ref(13);
+    gauss_jacobi(13, -0.5, -0.5, x.data(), w.data());
+    gauss_chebyshev(13, x_ref.data(), w_ref.data());
+    for (int i = 0; i != 13; ++i) {
+        REQUIRE_THAT(x[i], WithinAbs(x_ref[i], 5e-32));
+        REQUIRE_THAT(w[i], WithinRel(w_ref[i], 2e-30));
+    }
+
+    // Chebyshev polynomials of the second kind
+    x.resize(11);
+    w.resize(11);
+    gauss_jacobi(11, 0.5, 0.5, x.data(), w.data());
+    for (int i = 0; i != 11; ++i) {
+        DDouble theta = (i + 1) * xprec::numbers::pi / 12.0;
+        DDouble s = sin(theta);
+        REQUIRE_THAT(x[i], WithinAbs(-cos(theta), 5e-32));
+        REQUIRE_THAT(w[i], WithinRel(xprec::numbers::pi / 12.0 * s * s, 2e-30));
+    }
+
+    // Legendre polynomials
+    x.resize(20);
+    w.resize(20);
+    x_ref.resize(20);
+    w_ref.resize(20);
+    gauss_jacobi(20, 0.0, 0.0, x.data(), w.data());
+    gauss_legendre(20, x_ref.data(), w_ref.data());
+    for (int i = 0; i != 20; ++i) {
+        REQUIRE_THAT(x[i], WithinAbs(x_ref[i], 5e-32));
+        REQUIRE_THAT(w[i], WithinRel(w_ref[i], 2e-30));
+    }
+}
+
+TEST_CASE("jacobi-radau-lobatto", "[gauss]")
+{
+    const double alpha = 0.75, beta = -0.3;
+    const int n = 10;
+
+    // Reference integrals from a Gauss-Jacobi rule of higher order
+    std::vector<DDouble> x_ref(40), w_ref(40);
+    gauss_jacobi(40, alpha, beta, x_ref.data(), w_ref.data());
+
+    std::vector<DDouble> x(n), w(n);
+    gauss_jacobi(n, alpha, beta, x.data(), w.data());
+    for (int k = 0; k <= 2 * n - 1; ++k) {
+        DDouble ref = rule_moment(x_ref, w_ref, k);
+        REQUIRE_THAT(rule_moment(x, w, k), WithinAbs(ref, 1e-30));
+    }
+
+    gauss_jacobi_radau(n, alpha, beta, x.data(), w.data());
+    REQUIRE(x[0] == -1.0);
+    for (int k = 0; k <= 2 * n - 2; ++k) {
+        DDouble ref = rule_moment(x_ref, w_ref, k);
+        REQUIRE_THAT(rule_moment(x, w, k), WithinAbs(ref, 1e-30));
+    }
+
+    gauss_jacobi_lobatto(n, alpha, beta, x.data(), w.data());
+    REQUIRE(x[0] == -1.0);
+    REQUIRE(x[n - 1] == 1.0);
+    for (int k = 0; k <= 2 * n - 3; ++k) {
+        DDouble ref = rule_moment(x_ref, w_ref, k);
+        REQUIRE_THAT(rule_moment(x, w, k), WithinAbs(ref, 1e-30));
+    }
+
+    // Legendre-Gauss-Lobatto: end point weights 2/(n(n - 1))
+    gauss_jacobi_lobatto(n, 0.0, 0.0, x.data(), w.data());
+    REQUIRE_THAT(w[0], WithinRel(DDouble(2.0) / (n * (n - 1)), 2e-30));
+    REQUIRE_THAT(w[n - 1], WithinRel(DDouble(2.0) / (n * (n - 1)), 2e-30));
+
+    // There is no Lobatto rule with a single node
+    gauss_jacobi_lobatto(1, 0.0, 0.0, x.data(), w.data());
+    REQUIRE(isnan(x[0]));
+    REQUIRE(isnan(w[0]));
+}
+
+TEST_CASE("laguerre", "[gauss]")
+{
+    // Moments of x^alpha exp(-x) are Gamma(alpha + k + 1)
+    const int n = 15;
+    std::vector<DDouble> x(n), w(n);
+    for (double alpha : {0.0, 0.5}) {
+        gauss_laguerre(n, alpha, x.data(), w.data());
+        DDouble moment = alpha == 0 ? DDouble(1.0)
+                                    : 0.5 / xprec::numbers::inv_sqrtpi;
+        for (int k = 0; k <= 2 * n - 1; ++k) {
+            REQUIRE_THAT(rule_moment(x, w, k), WithinRel(moment, 1e-29));
+            moment *= k + 1.0 + alpha;
+        }
+    }
+
+    // Weights at the upper end underflow
+    x.resize(300);
+    w.resize(300);
+    gauss_laguerre(300, 0.0, x.data(), w.data());
+    REQUIRE_THAT(std::accumulate(w.begin(), w.end(), DDouble(0.0)),
+                 WithinRel(DDouble(1.0), 3e-30));
+}
+
+TEST_CASE("large-parameters", "[gauss]")
+{
+    // The weights sum to mu0, where Gamma(alpha + 1) is close to overflow
+    std::vector<DDouble> x(30), w(30);
+    gauss_laguerre(20, 150.5, x.data(), w.data());
+    REQUIRE_THAT(std::accumulate(w.begin(), w.begin() + 20, DDouble(0.0)),
+                 WithinRel(tgamma(MPFloat(151.5)), 1e-29));
+
+    // mu0 = 2^(alpha + beta + 1) B(alpha + 1, beta + 1), where the Gamma
+    // function in the denominator overflows for the second pair.
+    for (auto ab : {std::make_pair(80.3, 70.1), std::make_pair(120.3, 100.7)}) {
+        double alpha = ab.first, beta = ab.second;
+        gauss_jacobi(30, alpha, beta, x.data(), w.data());
+        MPFloat a = MPFloat(alpha) + 1, b = MPFloat(beta) + 1;
+        MPFloat mu0 = exp((a + b - 1) * log(MPFloat(2.0)) + lgamma(a) +
+                          lgamma(b) - lgamma(a + b));
+        REQUIRE_THAT(std::accumulate(w.begin(), w.end(), DDouble(0.0)),
+                     WithinRel(mu0, 1e-28));
+    }
+}
+
+TEST_CASE("hermite", "[gauss]")
+{
+    // Even moments of exp(-x^2) are sqrt(pi) (2k - 1)!! / 2^k
+    const int n = 20;
+    std::vector<DDouble> x(n), w(n);
+    gauss_hermite(n, x.data(), w.data());
+    DDouble moment = xprec::numbers::pi * xprec::numbers::inv_sqrtpi;
+    for (int k = 0; k <= n - 1; ++k) {
+        REQUIRE_THAT(rule_moment(x, w, 2 * k), WithinRel(moment, 1e-30));
+        REQUIRE_THAT(rule_moment(x, w, 2 * k + 1),
+                     WithinAbs(DDouble(0.0), 1e-30 * moment));
+        moment *= k + 0.5;
+    }
+
+    x.resize(501);
+    w.resize(501);
+    gauss_hermite(501, x.data(), w.data());
+    REQUIRE(x[250] == 0.0);
+    REQUIRE_THAT(std::accumulate(w.begin(), w.end(), DDouble(0.0)),
+                 WithinRel(xprec::numbers::pi * xprec::numbers::inv_sqrtpi,
+                           3e-30));
+}
+
+static DDouble clenshaw_direct(const char *rule, int n, int i)
+{
+    // Weights from the O(n) cosine series for a single node
+    const DDouble pi = xprec::numbers::pi;
+    DDouble sum = 0.0;
+    if (rule[0] == 'c') {
+        int N = n - 1;
+        if (N == 0)
+            return 2.0;
+        DDouble theta = pi * DDouble(1.0 * i) / (1.0 * N);
+        for (int j = 1; j <= N / 2; ++j) {
+            double b = 2 * j == N ? 1.0 : 2.0;
+            sum += b * cos((2.0 * j) * theta) / (4.0 * j * j - 1.0);
+        }
+        double c = i == 0 || i == N ? 1.0 : 2.0;
+        return DDouble(c) / N * (1.0 - sum);
+    } else if (rule[0] == '1') {
+        DDouble theta = pi * DDouble(i + 0.5) / (1.0 * n);
+        for (int j = 1; j <= n / 2; ++j)
+            sum += cos((2.0 * j) * theta) / (4.0 * j * j - 1.0);
+        return DDouble(2.0) / n * (1.0 - 2.0 * sum);
+    } else {
+        int N = n + 1;
+        DDouble theta = pi * DDouble(i + 1.0) / (1.0 * N);
+        for (int j = 1; j <= N / 2; ++j)
+            sum += sin((2.0 * j - 1.0) * theta) / (2.0 * j - 1.0);
+        return 4.0 * sin(theta) * sum / N;
+    }
+}
+
+TEST_CASE("clenshaw-curtis", "[gauss]")
+{
+    typedef void (*RuleFunc)(int, DDouble *, DDouble *);
+    const RuleFunc funcs[] = {xprec::clenshaw_curtis, xprec::fejer1,
+                              xprec::fejer2};
+    const char *names[] = {"cc", "1", "2"};
+
+    for (int r = 0; r != 3; ++r) {
+        for (int n : {1, 2, 3, 4, 7, 12, 17, 100, 129, 1000}) {
+            std::vector<DDouble> x(n), w(n);
+            funcs[r](n, x.data(), w.data());
+            CAPTURE(names[r]);
+            CAPTURE(n);
+
+            for (int i = 0; i != n; ++i) {
+                if (i != 0)
+                    REQUIRE(x[i - 1] < x[i]);
+                REQUIRE(w[i] == w[n - 1 - i]);
+                if (n <= 129 || i % 97 == 0) {
+                    CAPTURE(i);
+                    DDouble ref = clenshaw_direct(names[r], n, i);
+                    REQUIRE_THAT(w[i], WithinAbs(ref, 1e-31));
+                }
+            }
+
+            // Exact for polynomials up to degree n - 1
+            for (int k = 0; k <= std::min(n - 1, 40); k += 2) {
+                DDouble sum = 0.0;
+                for (int i = 0; i != n; ++i)
+                    sum += w[i] * pow(x[i], k);
+                CAPTURE(k);
+                REQUIRE_THAT(sum, WithinRel(2.0 / DDouble(k + 1), 3e-30));
+            }
+        }
+    }
+}
+
+TEST_CASE("clenshaw-curtis-nested", "[gauss]")
+{
+    for (int n : {3, 5, 9, 17, 33, 65}) {
+        std::vector<DDouble> x(n), x2(2 * n - 1);
+        xprec::clenshaw_curtis(n, x.data());
+        xprec::clenshaw_curtis(2 * n - 1, x2.data());
+        for (int i = 0; i != n; ++i)
+            REQUIRE(x[i] == x2[2 * i]);
+    }
+    for (int n : {1, 3, 7, 15, 31, 63}) {
+        std::vector<DDouble> x(n), x2(2 * n + 1);
+        xprec::fejer2(n, x.data());
+        xprec::fejer2(2 * n + 1, x2.data());
+        for (int i = 0; i != n; ++i)
+            REQUIRE(x[i] == x2[2 * i + 1]);
+    }
+}
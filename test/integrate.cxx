@@ -0,0 +1,212 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "catch2-addons.h"
+#include "xprec/ddouble.h"
+#include "xprec/integrate.h"
+#include "xprec/numbers.h"
+#include <atomic>
+#include <limits>
+#include <catch2/catch_test_macros.hpp>
+
+using xprec::DDouble;
+using xprec::GaussKronrodRule;
+using xprec::IntegrateOptions;
+using xprec::IntegrateResult;
+
+TEST_CASE("gauss-kronrod-exact", "[integrate]")
+{
+    for (int n : {1, 2, 5, 7, 10, 20}) {
+        GaussKronrodRule rule(n);
+        REQUIRE(rule.order() == n);
+        REQUIRE(rule.size() == size_t(2 * n + 1));
+        std::vector<DDouble> x(n), w(n);
+        gauss_legendre(n, x.data(), w.data());
+        for (int i = 0; i != n; ++i) {
+            REQUIRE(rule.x()[2 * i + 1] == x[i]);
+            REQUIRE(rule.gauss_w()[i] == w[i]);
+        }
+
+        // Interlacing, symmetric and exact for polynomials of degree 3n + 1
+        for (size_t i = 0; i != rule.size(); ++i) {
+            REQUIRE(rule.x()[i] == -rule.x()[2 * n - i]);
+            REQUIRE(rule.w()[i] == rule.w()[2 * n - i]);
+            if (i != 0)
+                REQUIRE(rule.x()[i - 1] < rule.x()[i]);
+        }
+        for (int k = 0; k <= 3 * n + 1; k += 2) {
+            DDouble sum = 0.0;
+            for (size_t i = 0; i != rule.size(); ++i)
+                sum += rule.w()[i] * pow(rule.x()[i], k);
+            CAPTURE(n);
+            CAPTURE(k);
+            REQUIRE_THAT(sum, WithinRel(2.0 / DDouble(k + 1), 3e-30));
+        }
+    }
+}
+
+TEST_CASE("integrate", "[integrate]")
+{
+    IntegrateResult res = xprec::integrate(
+        [](DDouble x) { return exp(x); }, 0.0, 1.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE(res.intervals == 1);
+    REQUIRE_THAT(res.value, WithinRel(exp(DDouble(1.0)) - 1.0, 1e-30));
+
+    // Sharp peak requires many intervals
+    res = xprec::integrate([](DDouble x) { return 1.0 / (1.0 + 1e4 * x * x); },
+                           -1.0, 1.0, 1e-29);
+    REQUIRE(res.ok);
+    REQUIRE(res.intervals > 1);
+    REQUIRE_THAT(res.value, WithinRel(atan(DDouble(100.0)) / 50.0, 1e-29));
+
+    // Singularity at the end point
+    res = xprec::integrate([](DDouble x) { return sqrt(x); }, 0.0, 1.0,
+                           1e-25);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(2.0) / 3.0, 1e-25));
+
+    // Integrable singularities at x = 0, which is a node of the Kronrod rule
+    res = xprec::integrate([](DDouble x) { return 1.0 / sqrt(abs(x)); },
+                           -1.0, 1.0, 1e-20);
+    REQUIRE(res.ok);
+    REQUIRE(res.evaluations < 100000);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(4.0), 1e-20));
+
+    res = xprec::integrate([](DDouble x) { return log(abs(x)); }, -1.0, 1.0,
+                           1e-20);
+    REQUIRE(res.ok);
+    REQUIRE(res.evaluations < 100000);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(-2.0), 1e-20));
+
+    // Vanishing integral converges on the round-off in the integral of |f|
+    res = xprec::integrate([](DDouble x) { return sin(x); }, -3.0, 3.0,
+                           1e-28);
+    REQUIRE(res.ok);
+    REQUIRE(res.intervals < 10);
+    REQUIRE_THAT(res.value, WithinAbs(DDouble(0.0), 1e-30));
+
+    // Reversed interval
+    res = xprec::integrate([](DDouble x) { return x * x; }, 1.0, -2.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(-3.0), 1e-30));
+}
+
+TEST_CASE("integrate-batch", "[integrate]")
+{
+    std::atomic<size_t> calls(0), points(0);
+    xprec::BatchIntegrand f = [&](const DDouble *x, DDouble *fx, size_t n) {
+        calls += 1;
+        points += n;
+        for (size_t i = 0; i != n; ++i)
+            fx[i] = cos(100.0 * x[i]) * exp(-x[i]);
+    };
+
+    IntegrateOptions options;
+    options.threads = 1;
+    IntegrateResult serial = xprec::integrate(f, 0.0, 4.0, 1e-28, options);
+    REQUIRE(serial.ok);
+    REQUIRE(points == serial.evaluations);
+    REQUIRE(calls < serial.intervals);
+
+    // Integral of cos(a x) exp(-x) over [0, L]
+    DDouble a = 100.0, L = 4.0;
+    DDouble ref = (1.0 - exp(-L) * (cos(a * L) - a * sin(a * L))) /
+                  (1.0 + a * a);
+    REQUIRE_THAT(serial.value, WithinAbs(ref, 1e-28));
+
+    // Result does not depend on the number of threads
+    options.threads = 4;
+    IntegrateResult parallel = xprec::integrate(f, 0.0, 4.0, 1e-28, options);
+    REQUIRE(parallel.value == serial.value);
+    REQUIRE(parallel.error == serial.error);
+    REQUIRE(parallel.intervals == serial.intervals);
+}
+
+TEST_CASE("integrate-fail", "[integrate]")
+{
+    IntegrateOptions options;
+    options.max_intervals = 4;
+    IntegrateResult res = xprec::integrate(
+        [](DDouble x) { return 1.0 / sqrt(x); }, 0.0, 1.0, 1e-30, options);
+    REQUIRE(!res.ok);
+    REQUIRE(res.intervals == 4);
+
+    options.max_intervals = 1000;
+    res = xprec::integrate([](DDouble x) { return 1.0 / x; }, 0.0, 1.0,
+                           1e-30, options);
+    REQUIRE(!res.ok);
+}
+
+TEST_CASE("tanh-sinh", "[integrate]")
+{
+    IntegrateResult res = xprec::tanh_sinh(
+        [](DDouble x) { return exp(x); }, 0.0, 1.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE(res.evaluations < 500);
+    REQUIRE_THAT(res.value, WithinRel(exp(DDouble(1.0)) - 1.0, 1e-30));
+
+    // Singularities at the end points
+    res = xprec::tanh_sinh([](DDouble x) { return 1.0 / sqrt(x); }, 0.0, 1.0,
+                           1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(2.0), 1e-30));
+
+    res = xprec::tanh_sinh([](DDouble x) { return log(x); }, 0.0, 1.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(-1.0), 1e-30));
+
+    // Close to b = 1, 1 - x is only accurate when computed from xc
+    res = xprec::tanh_sinh(
+        [](DDouble x, DDouble xc) {
+            return 1.0 / sqrt(xc < 0.0 ? -xc : 1.0 - x);
+        },
+        0.0, 1.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(2.0), 1e-30));
+
+    res = xprec::tanh_sinh([](DDouble x) { return sqrt(x); }, 1.0, 0.0, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(-2.0) / 3.0, 1e-30));
+
+    // Vanishing integral converges on the round-off in the integral of |f|
+    res = xprec::tanh_sinh([](DDouble x) { return x; }, -1.0, 1.0, 1e-28);
+    REQUIRE(res.ok);
+    REQUIRE(res.evaluations < 500);
+    REQUIRE_THAT(res.value, WithinAbs(DDouble(0.0), 1e-30));
+
+    // Absolute tolerance
+    res = xprec::tanh_sinh([](DDouble x) { return cos(x); }, 0.0, 1.0, 0.0,
+                           10, 1e-20);
+    REQUIRE(res.ok);
+    REQUIRE(res.error <= 1e-20);
+    REQUIRE_THAT(res.value, WithinAbs(sin(DDouble(1.0)), 1e-20));
+}
+
+TEST_CASE("tanh-sinh-infinite", "[integrate]")
+{
+    const DDouble pi = xprec::numbers::pi;
+    const DDouble inf = std::numeric_limits<DDouble>::infinity();
+
+    IntegrateResult res = xprec::tanh_sinh(
+        [](DDouble x) { return exp(-x); }, 0.0, inf, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(1.0), 1e-30));
+
+    res = xprec::tanh_sinh([](DDouble x) { return 1.0 / (1.0 + x * x); },
+                           1.0, inf, 1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(0.25 * pi, 1e-30));
+
+    res = xprec::tanh_sinh([](DDouble x) { return exp(x); }, -inf, 0.0,
+                           1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(DDouble(1.0), 1e-30));
+
+    res = xprec::tanh_sinh([](DDouble x) { return exp(-x * x); }, -inf, inf,
+                           1e-30);
+    REQUIRE(res.ok);
+    REQUIRE_THAT(res.value, WithinRel(sqrt(pi), 1e-30));
+}
@@ -0,0 +1,140 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/linalg.h"
+#include "catch2-addons.h"
+#include "mpfloat.h"
+#include "xprec/ddouble.h"
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <vector>
+
+using xprec::ExDouble;
+using xprec::RefinedSolver;
+
+/** Hilbert matrix in double-double, which is symmetric positive definite */
+static std::vector<DDouble> make_hilbert(size_t n)
+{
+    std::vector<DDouble> a(n * n);
+    for (size_t j = 0; j != n; ++j) {
+        for (size_t i = 0; i != n; ++i)
+            a[i + j * n] = reciprocal(ExDouble(i + j + 1.0));
+    }
+    return a;
+}
+
+/** Compute b = A x in multiple precision and round it to double-double */
+static std::vector<DDouble> make_rhs(size_t n, const std::vector<DDouble> &a,
+                                     size_t lda, const std::vector<DDouble> &x)
+{
+    std::vector<DDouble> b(n);
+    for (size_t i = 0; i != n; ++i) {
+        MPFloat s = 0;
+        for (size_t j = 0; j != n; ++j)
+            s += MPFloat(a[i + j * lda]) * MPFloat(x[j]);
+        b[i] = s.as_ddouble();
+    }
+    return b;
+}
+
+static std::vector<DDouble> make_vector(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<DDouble> x(n);
+    for (size_t i = 0; i != n; ++i)
+        x[i] = ExDouble(dist(rng)) + 1e-17 * dist(rng);
+    return x;
+}
+
+TEST_CASE("solve general", "[linalg]")
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    for (size_t n : {1, 5, 40, 150}) {
+        const size_t lda = n + 3;
+        std::vector<DDouble> a(lda * n);
+        for (size_t j = 0; j != n; ++j) {
+            for (size_t i = 0; i != n; ++i)
+                a[i + j * lda] = ExDouble(dist(rng)) + 1e-17 * dist(rng);
+        }
+
+        std::vector<DDouble> x_true = make_vector(n, n);
+        std::vector<DDouble> b = make_rhs(n, a, lda, x_true);
+        std::vector<DDouble> x(n);
+
+        int steps = xprec::solve(n, a.data(), lda, b.data(), x.data());
+        CAPTURE(n);
+        REQUIRE(steps >= 1);
+        REQUIRE(steps <= 5);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE_THAT(x[i], WithinAbs(x_true[i], n * 1e-29));
+    }
+}
+
+TEST_CASE("solve Hilbert", "[linalg]")
+{
+    // The Hilbert matrix of size 8 has a condition number of 1.5e10, which
+    // limits the forward error to about 1e10 u^2.
+    const size_t n = 8;
+    std::vector<DDouble> a = make_hilbert(n);
+    std::vector<DDouble> x_true = make_vector(n, 3);
+    std::vector<DDouble> b = make_rhs(n, a, n, x_true);
+
+    for (RefinedSolver::Method method :
+         {RefinedSolver::LU, RefinedSolver::CHOLESKY}) {
+        RefinedSolver solver(n, a.data(), n, method);
+        REQUIRE(solver.ok());
+        REQUIRE(solver.size() == n);
+
+        std::vector<DDouble> x(n);
+        int steps = solver.solve(b.data(), x.data());
+        REQUIRE(steps >= 1);
+        for (size_t i = 0; i != n; ++i)
+            REQUIRE_THAT(x[i], WithinAbs(x_true[i], 1e-20));
+    }
+
+    // Cholesky only references the lower triangle
+    std::vector<DDouble> a_lower = a;
+    for (size_t j = 1; j != n; ++j) {
+        for (size_t i = 0; i != j; ++i)
+            a_lower[i + j * n] = NAN;
+    }
+    RefinedSolver chol(n, a_lower.data(), n, RefinedSolver::CHOLESKY);
+    std::vector<DDouble> x(n);
+    REQUIRE(chol.solve(b.data(), x.data()) >= 1);
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE_THAT(x[i], WithinAbs(x_true[i], 1e-20));
+}
+
+TEST_CASE("solve failure", "[linalg]")
+{
+    // Singular matrix
+    std::vector<DDouble> a = {1.0, 2.0, 2.0, 4.0};
+    std::vector<DDouble> b = {1.0, 1.0}, x(2);
+    RefinedSolver singular(2, a.data(), 2);
+    REQUIRE(!singular.ok());
+    REQUIRE(singular.solve(b.data(), x.data()) == -1);
+    REQUIRE(isnan(x[0]));
+
+    // Not positive definite
+    std::vector<DDouble> c = {1.0, 2.0, 2.0, 1.0};
+    REQUIRE(!RefinedSolver(2, c.data(), 2, RefinedSolver::CHOLESKY).ok());
+    REQUIRE(RefinedSolver(2, c.data(), 2).ok());
+
+    // Hilbert matrix of size 14 is too ill-conditioned for refinement
+    const size_t n = 14;
+    std::vector<DDouble> h = make_hilbert(n);
+    std::vector<DDouble> y(n, 1.0), z(n);
+    RefinedSolver hilbert(n, h.data(), n);
+    if (hilbert.ok())
+        REQUIRE(hilbert.solve(y.data(), z.data()) == -1);
+
+    // Zero right-hand side
+    std::vector<DDouble> zero(2, 0.0);
+    REQUIRE(xprec::solve(2, c.data(), 2, zero.data(), x.data()) == 0);
+    REQUIRE(x[0] == 0);
+}
@@ -234,6 +234,8 @@ public:
     _DECLARE_UNARY_OP(exp2, mpfr_exp2)
     _DECLARE_UNARY_OP(exp10, mpfr_exp10)
     _DECLARE_UNARY_OP(expm1, mpfr_expm1)
+    _DECLARE_UNARY_OP(tgamma, mpfr_gamma)
+    _DECLARE_UNARY_OP(lgamma, mpfr_lngamma)
 
     _DECLARE_UNARY_OP(cos, mpfr_cos)
     _DECLARE_UNARY_OP(sin, mpfr_sin)
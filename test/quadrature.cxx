@@ -0,0 +1,189 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/quadrature.h"
+#include "xprec/ddouble.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using xprec::DDouble;
+using xprec::QuadratureCache;
+using xprec::QuadratureRule;
+
+TEST_CASE("rule cache", "[quadrature]")
+{
+    std::shared_ptr<const QuadratureRule> rule = xprec::gauss_legendre_rule(16);
+    REQUIRE(rule->size() == 16);
+
+    std::vector<DDouble> x(16), w(16);
+    gauss_legendre(16, x.data(), w.data());
+    for (int i = 0; i != 16; ++i) {
+        REQUIRE(rule->x()[i] == x[i]);
+        REQUIRE(rule->w()[i] == w[i]);
+    }
+    REQUIRE(xprec::gauss_legendre_rule(16) == rule);
+
+    std::shared_ptr<const QuadratureRule> cheb =
+        xprec::gauss_chebyshev_rule(16);
+    gauss_chebyshev(16, x.data(), w.data());
+    REQUIRE(cheb != rule);
+    REQUIRE(cheb->x()[3] == x[3]);
+    REQUIRE(cheb->w()[3] == w[3]);
+
+    // Invalid orders are rejected in all build modes
+    REQUIRE(xprec::gauss_legendre_rule(0) == nullptr);
+    REQUIRE(xprec::gauss_chebyshev_rule(-3) == nullptr);
+    REQUIRE(xprec::make_rule(QuadratureCache::GAUSS_LEGENDRE, 0) == nullptr);
+}
+
+TEST_CASE("rule cache threads", "[quadrature]")
+{
+    QuadratureCache cache;
+    const int nthreads = 4, max_n = 40;
+    std::vector<std::vector<const QuadratureRule *>> seen(
+        nthreads, std::vector<const QuadratureRule *>(max_n + 1));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != nthreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int rep = 0; rep != 3; ++rep) {
+                for (int k = 0; k != max_n; ++k) {
+                    int n = 1 + (k * 7 + t * 13) % max_n;
+                    seen[t][n] =
+                        cache.get(QuadratureCache::GAUSS_LEGENDRE, n).get();
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    // All threads must have got the same rule for each order
+    REQUIRE(cache.size() == max_n);
+    for (int n = 1; n <= max_n; ++n) {
+        REQUIRE(seen[0][n]->size() == size_t(n));
+        for (int t = 1; t != nthreads; ++t)
+            REQUIRE(seen[t][n] == seen[0][n]);
+    }
+}
+
+TEST_CASE("rule cache limits", "[quadrature]")
+{
+    QuadratureCache few(size_t(1) << 20, 2);
+    few.get(QuadratureCache::GAUSS_LEGENDRE, 5);
+    few.get(QuadratureCache::GAUSS_CHEBYSHEV, 5);
+    REQUIRE(few.size() == 2);
+
+    // Rules beyond the limit are still computed, but not stored
+    std::shared_ptr<const QuadratureRule> a =
+        few.get(QuadratureCache::GAUSS_LEGENDRE, 6);
+    std::shared_ptr<const QuadratureRule> b =
+        few.get(QuadratureCache::GAUSS_LEGENDRE, 6);
+    REQUIRE(a->size() == 6);
+    REQUIRE(a != b);
+    REQUIRE(few.size() == 2);
+
+    QuadratureCache small(100 * sizeof(DDouble), 100);
+    small.get(QuadratureCache::GAUSS_LEGENDRE, 30);
+    small.get(QuadratureCache::GAUSS_LEGENDRE, 30);
+    small.get(QuadratureCache::GAUSS_LEGENDRE, 40);
+    REQUIRE(small.size() == 1);
+    REQUIRE(small.bytes() == 60 * sizeof(DDouble));
+}
+
+TEST_CASE("rule file", "[quadrature]")
+{
+    const std::string path = "xprec-test-rules.bin";
+    const int orders[] = {40, 3, 17, 150, 3};
+    REQUIRE(xprec::save_rules(path, QuadratureCache::GAUSS_LEGENDRE, orders,
+                              5));
+
+    std::shared_ptr<const xprec::MappedRules> rules = xprec::load_rules(path);
+    REQUIRE(rules != nullptr);
+    REQUIRE(rules->size() == 4);
+    for (int n : {3, 17, 40, 150}) {
+        xprec::QuadratureRuleView view =
+            rules->find(QuadratureCache::GAUSS_LEGENDRE, n);
+        REQUIRE(view.size() == size_t(n));
+
+        std::vector<DDouble> x(n), w(n);
+        gauss_legendre(n, x.data(), w.data());
+        for (int i = 0; i != n; ++i) {
+            REQUIRE(view.x(i) == x[i]);
+            REQUIRE(view.w(i) == w[i]);
+        }
+    }
+    REQUIRE(rules->find(QuadratureCache::GAUSS_LEGENDRE, 4).size() == 0);
+    REQUIRE(rules->find(QuadratureCache::GAUSS_CHEBYSHEV, 3).size() == 0);
+
+    // Reject file with a different version
+    {
+        std::fstream file(path, std::ios::in | std::ios::out |
+                                    std::ios::binary);
+        file.seekp(8);
+        const char version[4] = {99, 0, 0, 0};
+        file.write(version, 4);
+    }
+    REQUIRE(xprec::load_rules(path) == nullptr);
+    std::remove(path.c_str());
+
+    REQUIRE(xprec::load_rules(path) == nullptr);
+    REQUIRE(!xprec::MappedRules(path).ok());
+
+    const int invalid[] = {5, 0};
+    REQUIRE(!xprec::save_rules(path, QuadratureCache::GAUSS_LEGENDRE, invalid,
+                               2));
+    REQUIRE(xprec::load_rules(path) == nullptr);
+}
+
+TEST_CASE("composite rule", "[quadrature]")
+{
+    std::vector<DDouble> edges = {-1.0, -0.25, 0.0, 0.0, 0.5, 2.0};
+    xprec::CompositeRule rule(edges, 7);
+    REQUIRE(rule.order() == 7);
+    REQUIRE(rule.segments() == 5);
+    REQUIRE(rule.size() == 35);
+    REQUIRE(rule.offsets()[0] == 0);
+    REQUIRE(rule.offsets()[5] == 35);
+
+    std::shared_ptr<const QuadratureRule> ref = xprec::gauss_legendre_rule(7);
+    for (size_t s = 0; s != rule.segments(); ++s) {
+        DDouble a = edges[s], b = edges[s + 1];
+        for (size_t i = rule.offsets()[s]; i != rule.offsets()[s + 1]; ++i) {
+            REQUIRE(rule.x()[i] >= a);
+            REQUIRE(rule.x()[i] <= b);
+            DDouble width = rule.x_minus_a()[i] + rule.b_minus_x()[i];
+            REQUIRE(abs(width - (b - a)) <= 1e-31);
+            if (i != 0)
+                REQUIRE(rule.x()[i - 1] <= rule.x()[i]);
+        }
+    }
+
+    // Exact for piecewise polynomials up to degree 13: x^13 on [-1, 0] and
+    // x^12 on [0, 2]
+    DDouble sum = 0.0;
+    for (size_t i = 0; i != rule.size(); ++i) {
+        DDouble x = rule.x()[i];
+        sum += rule.w()[i] * (x < 0.0 ? pow(x, 13) : pow(x, 12));
+    }
+    DDouble ref_sum = -1.0 / DDouble(14.0) + 8192.0 / DDouble(13.0);
+    REQUIRE(abs(sum - ref_sum) <= 1e-28);
+
+    // Tiny segment far from the origin: the distances to the edges are
+    // accurate relative to the segment width
+    DDouble a = 1e10, b = DDouble(1e10) + 1e-20;
+    xprec::CompositeRule tiny({a, b}, 4);
+    ref = xprec::gauss_legendre_rule(4);
+    for (size_t i = 0; i != 4; ++i) {
+        DDouble expected = 0.5e-20 * (1.0 + ref->x()[i]);
+        if (i >= 2)
+            expected = 0.5e-20 * (1.0 - ref->x()[i]);
+        DDouble got = i < 2 ? tiny.x_minus_a()[i] : tiny.b_minus_x()[i];
+        REQUIRE(abs(got - expected) <= 1e-30 * 1e-20);
+    }
+}
@@ -0,0 +1,224 @@
+/* Tests
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/simd.h"
+#include "catch2-addons.h"
+#include "xprec/ddouble.h"
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using xprec::DDoubleVec;
+using xprec::DoubleVec;
+using xprec::ExDouble;
+using xprec::ExDoubleVec;
+
+static std::vector<DDouble> make_values(size_t n, double scale)
+{
+    std::vector<DDouble> x(n);
+    DDouble v(scale, 3e-17 * scale);
+    for (size_t i = 0; i != n; ++i) {
+        x[i] = v;
+        v *= DDouble(-1.1373, 4.1e-17);
+    }
+    return x;
+}
+
+// Every lane performs the same sequence of operations as the scalar code.
+// The results are identical up to the compiler contracting some of the scalar
+// operations into FMAs, so we allow for a difference of a few ulps.
+#define REQUIRE_SAME(a, b)                                                     \
+    REQUIRE_THAT(DDouble(a), WithinRel(DDouble(b), 5e-32))
+
+template <int N>
+static void check_arith()
+{
+    const size_t n = 16 * N;
+    std::vector<DDouble> x = make_values(n, 2.25), y = make_values(n, -0.3);
+    std::vector<DDouble> z(n);
+
+    for (size_t i = 0; i < n; i += N) {
+        DDoubleVec<N> a = DDoubleVec<N>::load(&x[i]);
+        DDoubleVec<N> b = DDoubleVec<N>::load(&y[i]);
+        DoubleVec<N> bh = b.hi();
+
+        for (int k = 0; k != N; ++k)
+            REQUIRE(a[k] == x[i + k]);
+
+        for (int k = 0; k != N; ++k) {
+            REQUIRE_SAME((a + b)[k], x[i + k] + y[i + k]);
+            REQUIRE_SAME((a - b)[k], x[i + k] - y[i + k]);
+            REQUIRE_SAME((a * b)[k], x[i + k] * y[i + k]);
+            REQUIRE_SAME((a / b)[k], x[i + k] / y[i + k]);
+            REQUIRE_SAME(reciprocal(b)[k], reciprocal(y[i + k]));
+            REQUIRE_SAME(a.add_small(b)[k], x[i + k].add_small(y[i + k]));
+
+            REQUIRE_SAME((a + bh)[k], x[i + k] + y[i + k].hi());
+            REQUIRE_SAME((a * bh)[k], x[i + k] * y[i + k].hi());
+            REQUIRE_SAME((a / bh)[k], x[i + k] / y[i + k].hi());
+            REQUIRE_SAME((bh - a)[k], y[i + k].hi() - x[i + k]);
+        }
+
+        ExDoubleVec<N> ah = a.hi();
+        for (int k = 0; k != N; ++k) {
+            ExDouble ah_k = x[i + k].hi();
+            double bh_k = y[i + k].hi();
+            REQUIRE_SAME((ah + bh)[k], ah_k + bh_k);
+            REQUIRE_SAME((ah - bh)[k], ah_k - bh_k);
+            REQUIRE_SAME((ah * bh)[k], ah_k * bh_k);
+            REQUIRE_SAME((ah / bh)[k], ah_k / bh_k);
+            REQUIRE_SAME(reciprocal(ah)[k], reciprocal(ah_k));
+        }
+
+        (a * b).store(&z[i]);
+    }
+    for (size_t i = 0; i != n; ++i)
+        REQUIRE_SAME(z[i], x[i] * y[i]);
+}
+
+template <int N>
+static void check_planes()
+{
+    const size_t n = 8 * N;
+    std::vector<double> hi(n), lo(n), hi2(n), lo2(n);
+    std::vector<DDouble> x = make_values(n, 1.5);
+    for (size_t i = 0; i != n; ++i) {
+        hi[i] = x[i].hi();
+        lo[i] = x[i].lo();
+    }
+
+    DDoubleVec<N> acc = DDouble(0.0);
+    for (size_t i = 0; i < n; i += N) {
+        DDoubleVec<N> a = DDoubleVec<N>::load(&hi[i], &lo[i]);
+        acc += a;
+        (-a).store(&hi2[i], &lo2[i]);
+    }
+    for (size_t i = 0; i != n; ++i) {
+        REQUIRE(hi2[i] == -x[i].hi());
+        REQUIRE(lo2[i] == -x[i].lo());
+    }
+
+    DDouble sum = 0.0;
+    for (int k = 0; k != N; ++k) {
+        DDouble lane_sum = 0.0;
+        for (size_t i = k; i < n; i += N)
+            lane_sum += x[i];
+        REQUIRE(acc[k] == lane_sum);
+        sum += acc[k];
+    }
+    REQUIRE(isfinite(sum));
+}
+
+template <int N>
+static void check_two_prod()
+{
+    // Include values close to overflow, where the splitting needs scaling
+    std::vector<double> a, b;
+    for (double ai = 1.7e308; ai > 1e-140; ai *= -.6173) {
+        a.push_back(ai);
+        b.push_back(1e-9 / ai);
+        a.push_back(ai);
+        b.push_back(-1.03);
+    }
+    a.resize(a.size() / N * N);
+
+    for (size_t i = 0; i < a.size(); i += N) {
+        DoubleVec<N> av = DoubleVec<N>::load(&a[i]);
+        DoubleVec<N> bv = DoubleVec<N>::load(&b[i]);
+        DoubleVec<N> ev;
+        DoubleVec<N> pv = xprec::_internal::two_prod_dekker(av, bv, ev);
+        for (int k = 0; k != N; ++k) {
+            double e;
+            double p = xprec::_internal::two_prod_dekker(a[i + k], b[i + k], e);
+            REQUIRE(pv[k] == p);
+            REQUIRE(ev[k] == e);
+        }
+    }
+}
+
+template <int N>
+static void check_ldexp()
+{
+    // Include results that are subnormal or overflow
+    std::vector<double> x, k;
+    for (int e = -1022; e <= 1023; e += 7) {
+        x.push_back(-1.3791 * e + 0.25);
+        k.push_back(e);
+        x.push_back(1.7e308);
+        k.push_back(e);
+        x.push_back(3.1e-300);
+        k.push_back(-e);
+    }
+    x.resize(x.size() / N * N);
+
+    for (size_t i = 0; i < x.size(); i += N) {
+        DoubleVec<N> xv = DoubleVec<N>::load(&x[i]);
+        DoubleVec<N> kv = DoubleVec<N>::load(&k[i]);
+        DoubleVec<N> yv = ldexp(xv, kv);
+        DDoubleVec<N> zv = ldexp(DDoubleVec<N>(xv, 1e-17 * xv), kv);
+        for (int l = 0; l != N; ++l) {
+            REQUIRE(yv[l] == std::ldexp(x[i + l], (int)k[i + l]));
+            REQUIRE(zv[l] == ldexp(DDouble(x[i + l], 1e-17 * x[i + l]),
+                                   (int)k[i + l]));
+        }
+    }
+}
+
+template <int N>
+static void check_logb()
+{
+    std::vector<double> x = {1.0, -0.5, std::nextafter(2.0, 0.0),
+                             2.2250738585072014e-308};
+    for (double xi = 1.7e308; std::fabs(xi) > 1e-307; xi *= -.3173)
+        x.push_back(xi);
+    x.resize(x.size() / N * N);
+
+    for (size_t i = 0; i < x.size(); i += N) {
+        DoubleVec<N> yv = logb(DoubleVec<N>::load(&x[i]));
+        for (int l = 0; l != N; ++l)
+            REQUIRE(yv[l] == std::logb(x[i + l]));
+    }
+}
+
+TEST_CASE("simd two_prod", "[simd]")
+{
+    check_two_prod<1>();
+    check_two_prod<2>();
+    check_two_prod<4>();
+    check_two_prod<8>();
+}
+
+TEST_CASE("simd arith", "[simd]")
+{
+    check_arith<1>();
+    check_arith<2>();
+    check_arith<3>();
+    check_arith<4>();
+    check_arith<8>();
+    check_arith<XPREC_SIMD_WIDTH>();
+}
+
+TEST_CASE("simd planes", "[simd]")
+{
+    check_planes<1>();
+    check_planes<2>();
+    check_planes<4>();
+    check_planes<8>();
+}
+
+TEST_CASE("simd ldexp", "[simd]")
+{
+    check_ldexp<1>();
+    check_ldexp<2>();
+    check_ldexp<4>();
+    check_ldexp<8>();
+}
+
+TEST_CASE("simd logb", "[simd]")
+{
+    check_logb<1>();
+    check_logb<2>();
+    check_logb<4>();
+    check_logb<8>();
+}
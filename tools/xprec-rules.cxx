@@ -0,0 +1,54 @@
+/* Precompute quadrature rules and store them in a file.
+ *
+ * Copyright (C) 2023 Markus Wallerberger and others
+ * SPDX-License-Identifier: MIT
+ */
+#include "xprec/quadrature.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-c] FILE MIN_N MAX_N [STEP]\n\n"
+                 "Compute Gauss-Legendre rules of orders MIN_N, MIN_N + STEP,"
+                 " ..., MAX_N and\nwrite them to FILE, which can be loaded"
+                 " with xprec::load_rules().\n\n"
+                 "  -c    compute Gauss-Chebyshev rules instead\n",
+                 argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    xprec::QuadratureCache::Family family =
+        xprec::QuadratureCache::GAUSS_LEGENDRE;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "-c") == 0) {
+        family = xprec::QuadratureCache::GAUSS_CHEBYSHEV;
+        ++arg;
+    }
+    if (argc - arg < 3 || argc - arg > 4) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const char *path = argv[arg];
+    int min_n = std::atoi(argv[arg + 1]);
+    int max_n = std::atoi(argv[arg + 2]);
+    int step = argc - arg == 4 ? std::atoi(argv[arg + 3]) : 1;
+    if (min_n < 1 || max_n < min_n || step < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<int> orders;
+    for (int n = min_n; n <= max_n; n += step)
+        orders.push_back(n);
+    if (!xprec::save_rules(path, family, orders.data(), orders.size())) {
+        std::fprintf(stderr, "%s: cannot write %s\n", argv[0], path);
+        return 1;
+    }
+    return 0;
+}